@@ -0,0 +1,398 @@
+// Copyright 2020 CryptoGarage
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "cfd/cfd_transaction.h"
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_ecdsa_adaptor.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_context.h"
+#include "cfddlc/cfddlc_hash.h"
+#include "cfddlc/cfddlc_oracle.h"
+#include "cfddlc/cfddlc_point.h"
+#include "cfddlc/cfddlc_transactions.h"
+
+using cfd::Amount;
+using cfd::TransactionController;
+using cfd::core::Address;
+using cfd::core::ByteData256;
+using cfd::core::HashUtil;
+using cfd::core::NetType;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+using cfd::core::Txid;
+using cfd::core::TxIn;
+using cfd::core::WitnessVersion;
+
+using cfd::dlc::BatchHashUtil;
+using cfd::dlc::CetSignatureHasher;
+using cfd::dlc::CetTemplate;
+using cfd::dlc::DlcCryptoContext;
+using cfd::dlc::DlcManager;
+using cfd::dlc::DlcOutcome;
+using cfd::dlc::JacobianPoint;
+using cfd::dlc::OracleNonceContext;
+using cfd::dlc::OraclePubkeyTable;
+using cfd::dlc::PartyParams;
+using cfd::dlc::TxInputInfo;
+
+#ifndef ECMULT_GEN_PREC_BITS
+// the precision of the secp256k1 signing table, set by CMake.
+#define ECMULT_GEN_PREC_BITS 4
+#endif
+
+/**
+ * @brief Data shared by all benchmarks: a contract with nb_cets CETs, each
+ * one attested using nb_nonces messages.
+ */
+struct BenchContract {
+  Privkey oracle_privkey;
+  SchnorrPubkey oracle_pubkey;
+  std::vector<SchnorrPubkey> oracle_r_values;
+  Privkey local_fund_privkey;
+  Pubkey local_fund_pubkey;
+  Pubkey remote_fund_pubkey;
+  PartyParams local_params;
+  PartyParams remote_params;
+  std::vector<DlcOutcome> outcomes;
+  std::vector<TransactionController> cets;
+  cfd::Script lock_script;
+  Amount fund_amount;
+  std::vector<std::vector<ByteData256>> msgs;
+};
+
+static Privkey CreatePrivkey(uint32_t index) {
+  std::vector<uint8_t> bytes(32, 0);
+  bytes[28] = static_cast<uint8_t>(index >> 24);
+  bytes[29] = static_cast<uint8_t>(index >> 16);
+  bytes[30] = static_cast<uint8_t>(index >> 8);
+  bytes[31] = static_cast<uint8_t>(index);
+  return Privkey(ByteData256(bytes));
+}
+
+static BenchContract CreateBenchContract(size_t nb_cets, size_t nb_nonces) {
+  BenchContract contract;
+  contract.oracle_privkey = CreatePrivkey(0x0100);
+  contract.oracle_pubkey = SchnorrPubkey::FromPrivkey(contract.oracle_privkey);
+  for (size_t i = 0; i < nb_nonces; i++) {
+    contract.oracle_r_values.push_back(SchnorrPubkey::FromPrivkey(
+      CreatePrivkey(0x0200 + static_cast<uint32_t>(i))));
+  }
+  contract.local_fund_privkey = CreatePrivkey(1);
+  contract.local_fund_pubkey = contract.local_fund_privkey.GeneratePubkey();
+  contract.remote_fund_pubkey = CreatePrivkey(2).GeneratePubkey();
+
+  auto collateral = Amount::CreateBySatoshiAmount(100000000);
+  auto input_amount = Amount::CreateByCoinAmount(50);
+  std::vector<TxInputInfo> local_inputs = {TxInputInfo{
+    TxIn(
+      Txid("83266d6b22a9babf6ee469b88fd0d3a0c690525f7c903aff22ec8ee44214604f"),
+      0, 0),
+    108, 0}};
+  std::vector<TxInputInfo> remote_inputs = {TxInputInfo{
+    TxIn(
+      Txid("bc92a22f07ef23c53af343397874b59f5f8c0eb37753af1d1a159a2177d4bb98"),
+      0, 0),
+    108, 0}};
+  Address local_final(
+    NetType::kRegtest, WitnessVersion::kVersion0,
+    CreatePrivkey(7).GeneratePubkey());
+  Address remote_final(
+    NetType::kRegtest, WitnessVersion::kVersion0,
+    CreatePrivkey(8).GeneratePubkey());
+  Address local_change(
+    NetType::kRegtest, WitnessVersion::kVersion0,
+    CreatePrivkey(5).GeneratePubkey());
+  Address remote_change(
+    NetType::kRegtest, WitnessVersion::kVersion0,
+    CreatePrivkey(6).GeneratePubkey());
+
+  contract.local_params = {
+    contract.local_fund_pubkey,
+    local_change.GetLockingScript(),
+    local_final.GetLockingScript(),
+    local_inputs,
+    input_amount,
+    collateral,
+    0,
+    0};
+  contract.remote_params = {
+    contract.remote_fund_pubkey,
+    remote_change.GetLockingScript(),
+    remote_final.GetLockingScript(),
+    remote_inputs,
+    input_amount,
+    collateral,
+    0,
+    0};
+
+  auto total = collateral + collateral;
+  for (size_t i = 0; i < nb_cets; i++) {
+    auto local_payout = Amount::CreateBySatoshiAmount(
+      static_cast<int64_t>((i * 997) % 200000000));
+    contract.outcomes.push_back({local_payout, total - local_payout});
+    std::vector<ByteData256> cet_msgs;
+    for (size_t j = 0; j < nb_nonces; j++) {
+      cet_msgs.push_back(HashUtil::Sha256(std::to_string((i >> j) & 1)));
+    }
+    contract.msgs.push_back(cet_msgs);
+  }
+
+  auto transactions = DlcManager::CreateDlcTransactions(
+    contract.outcomes, contract.local_params, contract.remote_params, 100, 1);
+  contract.cets = transactions.cets;
+  contract.lock_script = DlcManager::CreateFundTxLockingScript(
+    contract.local_fund_pubkey, contract.remote_fund_pubkey);
+  contract.fund_amount =
+    transactions.fund_transaction.GetTransaction().GetTxOut(0).GetValue();
+  return contract;
+}
+
+static double GetElapsedMs(
+  const std::chrono::steady_clock::time_point &start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+static void PrintResult(
+  const std::string &name, size_t nb_items, double elapsed_ms,
+  double base_ms) {
+  std::cout << std::left << std::setw(44) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(1)
+            << elapsed_ms << " ms" << std::setw(12) << std::setprecision(0)
+            << (static_cast<double>(nb_items) * 1000.0 / elapsed_ms)
+            << " /s" << std::setw(8) << std::setprecision(2)
+            << (base_ms / elapsed_ms) << "x" << std::endl;
+}
+
+static void BenchCreateCetAdaptorSignatures(const BenchContract &contract) {
+  const auto &cets = contract.cets;
+  auto start = std::chrono::steady_clock::now();
+  DlcManager::CreateCetAdaptorSignatures(
+    cets, contract.oracle_pubkey, contract.oracle_r_values,
+    contract.local_fund_privkey, contract.lock_script, contract.fund_amount,
+    contract.msgs);
+  auto base_ms = GetElapsedMs(start);
+  PrintResult("CreateCetAdaptorSignatures", cets.size(), base_ms, base_ms);
+
+  auto max_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  for (uint32_t nb_threads = 1;;
+       nb_threads = std::min(nb_threads * 2, max_threads)) {
+    start = std::chrono::steady_clock::now();
+    DlcManager::CreateCetAdaptorSignatures(
+      cets, contract.oracle_pubkey, contract.oracle_r_values,
+      contract.local_fund_privkey, contract.lock_script, contract.fund_amount,
+      contract.msgs, nb_threads);
+    PrintResult(
+      "CreateCetAdaptorSignatures threads=" + std::to_string(nb_threads),
+      cets.size(), GetElapsedMs(start), base_ms);
+    if (nb_threads == max_threads) {
+      break;
+    }
+  }
+}
+
+static void BenchVerifyCetAdaptorSignatures(const BenchContract &contract) {
+  const auto &cets = contract.cets;
+  auto sigs = DlcManager::CreateCetAdaptorSignatures(
+    cets, contract.oracle_pubkey, contract.oracle_r_values,
+    contract.local_fund_privkey, contract.lock_script, contract.fund_amount,
+    contract.msgs);
+
+  // one CET at a time, with the constant time oracle pubkey multiplication.
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < cets.size(); i++) {
+    DlcManager::VerifyCetAdaptorSignature(
+      sigs[i], cets[i], contract.local_fund_pubkey, contract.oracle_pubkey,
+      contract.oracle_r_values, contract.lock_script, contract.fund_amount,
+      contract.msgs[i]);
+  }
+  auto base_ms = GetElapsedMs(start);
+  PrintResult("VerifyCetAdaptorSignature", cets.size(), base_ms, base_ms);
+
+  start = std::chrono::steady_clock::now();
+  OracleNonceContext context(
+    std::make_shared<const OraclePubkeyTable>(contract.oracle_pubkey),
+    contract.oracle_r_values);
+  for (size_t i = 0; i < cets.size(); i++) {
+    DlcManager::VerifyCetAdaptorSignature(
+      sigs[i], cets[i], contract.local_fund_pubkey, context,
+      contract.lock_script, contract.fund_amount, contract.msgs[i]);
+  }
+  PrintResult(
+    "VerifyCetAdaptorSignature vartime", cets.size(), GetElapsedMs(start),
+    base_ms);
+
+  start = std::chrono::steady_clock::now();
+  DlcManager::VerifyCetAdaptorSignatures(
+    cets, sigs, contract.msgs, contract.local_fund_pubkey,
+    contract.oracle_pubkey, contract.oracle_r_values, contract.lock_script,
+    contract.fund_amount, 1);
+  PrintResult(
+    "VerifyCetAdaptorSignatures", cets.size(), GetElapsedMs(start), base_ms);
+}
+
+static void BenchSha256D(size_t nb_messages) {
+  // the size of a CET signature hash preimage.
+  std::vector<std::vector<uint8_t>> messages(nb_messages);
+  for (size_t i = 0; i < nb_messages; i++) {
+    messages[i].assign(228, static_cast<uint8_t>(i));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  BatchHashUtil::Sha256D(messages, false);
+  auto base_ms = GetElapsedMs(start);
+  PrintResult("Sha256D scalar", nb_messages, base_ms, base_ms);
+
+  if (BatchHashUtil::IsSimdAvailable()) {
+    start = std::chrono::steady_clock::now();
+    BatchHashUtil::Sha256D(messages);
+    PrintResult("Sha256D simd", nb_messages, GetElapsedMs(start), base_ms);
+  }
+}
+
+static CetSignatureHasher CreateSignatureHasher(
+  const BenchContract &contract) {
+  auto fund_input = contract.cets[0].GetTransaction().GetTxIn(0);
+  CetTemplate cet_template(
+    fund_input.GetTxid(), fund_input.GetVout(),
+    contract.local_params.final_script_pubkey,
+    contract.remote_params.final_script_pubkey, 0,
+    contract.local_params.payout_serial_id,
+    contract.remote_params.payout_serial_id);
+  return CetSignatureHasher(
+    cet_template, contract.lock_script, contract.fund_amount);
+}
+
+static void BenchPrecomputedAdaptorPoints(const BenchContract &contract) {
+  auto sig_hasher = CreateSignatureHasher(contract);
+  const auto &outcomes = contract.outcomes;
+  auto start = std::chrono::steady_clock::now();
+  DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, contract.oracle_pubkey, contract.oracle_r_values,
+    contract.local_fund_privkey, contract.msgs);
+  auto base_ms = GetElapsedMs(start);
+  PrintResult(
+    "CreateCetAdaptorSignatures outcomes", outcomes.size(), base_ms, base_ms);
+
+  start = std::chrono::steady_clock::now();
+  auto adaptor_points = DlcManager::ComputeAdaptorPoints(
+    contract.msgs, contract.oracle_r_values, contract.oracle_pubkey);
+  PrintResult(
+    "ComputeAdaptorPoints (offline)", outcomes.size(), GetElapsedMs(start),
+    base_ms);
+
+  start = std::chrono::steady_clock::now();
+  DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_points, contract.local_fund_privkey);
+  PrintResult(
+    "CreateCetAdaptorSignatures (online)", outcomes.size(),
+    GetElapsedMs(start), base_ms);
+}
+
+static void BenchSignatureHashes(const BenchContract &contract) {
+  const auto &cets = contract.cets;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &cet : cets) {
+    cet.GetTransaction().GetSignatureHash(
+      0, contract.lock_script.GetData(), cfd::core::SigHashType(),
+      contract.fund_amount, WitnessVersion::kVersion0);
+  }
+  auto base_ms = GetElapsedMs(start);
+  PrintResult("Transaction::GetSignatureHash", cets.size(), base_ms, base_ms);
+
+  auto sig_hasher = CreateSignatureHasher(contract);
+  start = std::chrono::steady_clock::now();
+  for (const auto &outcome : contract.outcomes) {
+    sig_hasher.GetSignatureHash(outcome);
+  }
+  PrintResult(
+    "CetSignatureHasher::GetSignatureHash", cets.size(), GetElapsedMs(start),
+    base_ms);
+
+  start = std::chrono::steady_clock::now();
+  sig_hasher.GetSignatureHashes(contract.outcomes);
+  PrintResult(
+    "CetSignatureHasher::GetSignatureHashes", cets.size(),
+    GetElapsedMs(start), base_ms);
+}
+
+static void BenchOraclePubkeyTable(const BenchContract &contract) {
+  OracleNonceContext context(contract.oracle_pubkey, contract.oracle_r_values);
+  auto start = std::chrono::steady_clock::now();
+  DlcManager::ComputeAdaptorPoints(contract.msgs, context);
+  auto base_ms = GetElapsedMs(start);
+  PrintResult(
+    "ComputeAdaptorPoints tweak mul", contract.msgs.size(), base_ms, base_ms);
+
+  start = std::chrono::steady_clock::now();
+  auto pubkey_table =
+    std::make_shared<const OraclePubkeyTable>(contract.oracle_pubkey);
+  PrintResult("OraclePubkeyTable build", 1, GetElapsedMs(start), base_ms);
+
+  OracleNonceContext table_context(pubkey_table, contract.oracle_r_values);
+  start = std::chrono::steady_clock::now();
+  DlcManager::ComputeAdaptorPoints(contract.msgs, table_context);
+  PrintResult(
+    "ComputeAdaptorPoints table", contract.msgs.size(), GetElapsedMs(start),
+    base_ms);
+}
+
+static void BenchPointNormalization(const BenchContract &contract) {
+  // sums of two oracle points, one per CET.
+  JacobianPoint oracle_point(contract.oracle_pubkey.CreatePubkey());
+  std::vector<JacobianPoint> points;
+  JacobianPoint sum = oracle_point;
+  for (size_t i = 0; i < contract.msgs.size(); i++) {
+    sum = sum.Add(oracle_point);
+    points.push_back(sum);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &point : points) {
+    point.ToPubkey();
+  }
+  auto base_ms = GetElapsedMs(start);
+  PrintResult("JacobianPoint::ToPubkey", points.size(), base_ms, base_ms);
+
+  start = std::chrono::steady_clock::now();
+  JacobianPoint::ToPubkeys(points);
+  PrintResult(
+    "JacobianPoint::ToPubkeys", points.size(), GetElapsedMs(start), base_ms);
+}
+
+/**
+ * @brief Usage: cfddlc_bench [nb_cets] [nb_nonces]
+ */
+int main(int argc, char *argv[]) {
+  size_t nb_cets = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  size_t nb_nonces = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1;
+  if (nb_cets == 0 || nb_nonces == 0) {
+    std::cerr << "usage: " << argv[0] << " [nb_cets] [nb_nonces]" << std::endl;
+    return 1;
+  }
+
+  DlcCryptoContext::InitializeSecpContext();
+  std::cout << "nb_cets=" << nb_cets << " nb_nonces=" << nb_nonces
+            << " hardware_threads=" << std::thread::hardware_concurrency()
+            << " ecmult_gen_prec_bits=" << ECMULT_GEN_PREC_BITS << std::endl;
+  auto contract = CreateBenchContract(nb_cets, nb_nonces);
+  BenchCreateCetAdaptorSignatures(contract);
+  BenchVerifyCetAdaptorSignatures(contract);
+  BenchSignatureHashes(contract);
+  BenchPrecomputedAdaptorPoints(contract);
+  BenchOraclePubkeyTable(contract);
+  BenchPointNormalization(contract);
+  BenchSha256D(nb_cets);
+  return 0;
+}
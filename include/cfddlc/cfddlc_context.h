@@ -0,0 +1,285 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_CONTEXT_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_CONTEXT_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cfd/cfd_transaction.h"
+#include "cfdcore/cfdcore_key.h"
+#include "cfdcore/cfdcore_schnorrsig.h"
+#include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_oracle.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::Amount;
+using cfd::Script;
+using cfd::TransactionController;
+using cfd::Txid;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+
+/**
+ * @brief The keys used to sign and verify the CETs of a contract, prepared
+ * once for all of them: the oracle pubkey and r values are lifted and parsed
+ * into an OracleNonceContext backed by an OraclePubkeyTable, the public key
+ * of the local funding private key is derived once, and so is the position
+ * of the local signature in the fund multisig script. The context is
+ * immutable and can be shared between threads.
+ *
+ */
+class CFD_DLC_EXPORT DlcCryptoContext {
+ public:
+  /**
+   * @brief Create the secp256k1 context shared with cfd-core and randomize
+   * it, blinding the constant time signing operations. Neither the creation
+   * nor the randomization of the shared context is thread safe, so this
+   * must be called once at startup, before any thread uses cfd-core or
+   * cfd-dlc. Later calls do nothing. It is never called implicitly: the bulk
+   * functions of DlcManager only create the shared context (without
+   * randomizing it) before starting their workers.
+   *
+   * @throw CfdException if the context cannot be randomized.
+   */
+  static void InitializeSecpContext();
+
+  /**
+   * @brief Construct a new Dlc Crypto Context object.
+   *
+   * @param oracle_pubkey the pubkey of the oracle for the event.
+   * @param oracle_r_values the r values that the oracle will use for the
+   * event.
+   * @param local_fund_privkey the private key of the local party for the
+   * fund output.
+   * @param remote_fund_pubkey the public key of the remote party for the fund
+   * output.
+   */
+  DlcCryptoContext(
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &local_fund_privkey,
+    const Pubkey &remote_fund_pubkey);
+
+  /**
+   * @brief Construct a new Dlc Crypto Context object sharing the
+   * multiplication table of the oracle pubkey (e.g. with the other contracts
+   * using the same oracle).
+   *
+   * @param pubkey_table the multiplication table of the oracle pubkey.
+   * @param oracle_r_values the r values that the oracle will use for the
+   * event.
+   * @param local_fund_privkey the private key of the local party for the
+   * fund output.
+   * @param remote_fund_pubkey the public key of the remote party for the fund
+   * output.
+   */
+  DlcCryptoContext(
+    const std::shared_ptr<const OraclePubkeyTable> &pubkey_table,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &local_fund_privkey,
+    const Pubkey &remote_fund_pubkey);
+
+  /**
+   * @brief Get the nonce context of the oracle event.
+   *
+   * @return const OracleNonceContext& the nonce context.
+   */
+  const OracleNonceContext &GetNonceContext() const;
+
+  /**
+   * @brief Get the funding private key of the local party.
+   *
+   * @return const Privkey& the private key.
+   */
+  const Privkey &GetLocalFundPrivkey() const;
+
+  /**
+   * @brief Get the funding public key of the local party.
+   *
+   * @return const Pubkey& the public key.
+   */
+  const Pubkey &GetLocalFundPubkey() const;
+
+  /**
+   * @brief Get the funding public key of the remote party.
+   *
+   * @return const Pubkey& the public key.
+   */
+  const Pubkey &GetRemoteFundPubkey() const;
+
+  /**
+   * @brief Check whether the local fund pubkey is the first one of the
+   * multisig script of the fund output, i.e. whether the local signature
+   * comes first.
+   *
+   * @return true if the local fund pubkey is first.
+   * @return false otherwise.
+   */
+  bool IsLocalPubkeyFirst() const;
+
+ private:
+  /**
+   * @brief The nonce context of the oracle event.
+   */
+  OracleNonceContext nonce_context_;
+  /**
+   * @brief The funding private key of the local party.
+   */
+  Privkey local_fund_privkey_;
+  /**
+   * @brief The funding public key of the local party.
+   */
+  Pubkey local_fund_pubkey_;
+  /**
+   * @brief The funding public key of the remote party.
+   */
+  Pubkey remote_fund_pubkey_;
+  /**
+   * @brief Whether the local fund pubkey is first in the multisig script.
+   */
+  bool is_local_first_;
+};
+
+/**
+ * @brief The parts of a contract that every signature over the fund output
+ * depends on, computed once: the 2-of-2 multisig script of the fund output
+ * and its P2WSH script pubkey, the position of the local fund pubkey in the
+ * multisig script, and the outpoint and value of the fund output. The
+ * context is immutable and can be shared between threads.
+ *
+ */
+class CFD_DLC_EXPORT DlcContractContext {
+ public:
+  /**
+   * @brief Construct a new Dlc Contract Context object.
+   *
+   * @param local_fund_pubkey the fund public key of the local party.
+   * @param remote_fund_pubkey the fund public key of the remote party.
+   * @param fund_tx_id the id of the fund transaction.
+   * @param fund_vout the vout of the fund output.
+   * @param fund_amount the value of the fund output.
+   */
+  DlcContractContext(
+    const Pubkey &local_fund_pubkey,
+    const Pubkey &remote_fund_pubkey,
+    const Txid &fund_tx_id,
+    uint32_t fund_vout,
+    const Amount &fund_amount);
+
+  /**
+   * @brief Construct a new Dlc Contract Context object, looking up the fund
+   * output in the fund transaction.
+   *
+   * @param local_fund_pubkey the fund public key of the local party.
+   * @param remote_fund_pubkey the fund public key of the remote party.
+   * @param fund_tx the fund transaction.
+   * @throw CfdException if the fund transaction has no output paying to the
+   * multisig script of the fund pubkeys.
+   */
+  DlcContractContext(
+    const Pubkey &local_fund_pubkey,
+    const Pubkey &remote_fund_pubkey,
+    const TransactionController &fund_tx);
+
+  /**
+   * @brief Get the fund public key of the local party.
+   *
+   * @return const Pubkey& the public key.
+   */
+  const Pubkey &GetLocalFundPubkey() const;
+
+  /**
+   * @brief Get the fund public key of the remote party.
+   *
+   * @return const Pubkey& the public key.
+   */
+  const Pubkey &GetRemoteFundPubkey() const;
+
+  /**
+   * @brief Get the multisig script locking the fund output.
+   *
+   * @return const Script& the multisig script.
+   */
+  const Script &GetFundLockingScript() const;
+
+  /**
+   * @brief Get the P2WSH script pubkey of the fund output.
+   *
+   * @return const Script& the script pubkey.
+   */
+  const Script &GetFundScriptPubkey() const;
+
+  /**
+   * @brief Check whether the local fund pubkey is the first one of the
+   * multisig script, i.e. whether the local signature comes first.
+   *
+   * @return true if the local fund pubkey is first.
+   * @return false otherwise.
+   */
+  bool IsLocalPubkeyFirst() const;
+
+  /**
+   * @brief Get the id of the fund transaction.
+   *
+   * @return const Txid& the transaction id.
+   */
+  const Txid &GetFundTxId() const;
+
+  /**
+   * @brief Get the vout of the fund output.
+   *
+   * @return uint32_t the vout.
+   */
+  uint32_t GetFundVout() const;
+
+  /**
+   * @brief Get the value of the fund output.
+   *
+   * @return const Amount& the value.
+   */
+  const Amount &GetFundAmount() const;
+
+ private:
+  /**
+   * @brief The fund public key of the local party.
+   */
+  Pubkey local_fund_pubkey_;
+  /**
+   * @brief The fund public key of the remote party.
+   */
+  Pubkey remote_fund_pubkey_;
+  /**
+   * @brief The multisig script locking the fund output.
+   */
+  Script fund_lockscript_;
+  /**
+   * @brief The P2WSH script pubkey of the fund output.
+   */
+  Script fund_script_pubkey_;
+  /**
+   * @brief Whether the local fund pubkey is first in the multisig script.
+   */
+  bool is_local_first_;
+  /**
+   * @brief The id of the fund transaction.
+   */
+  Txid fund_tx_id_;
+  /**
+   * @brief The vout of the fund output.
+   */
+  uint32_t fund_vout_;
+  /**
+   * @brief The value of the fund output.
+   */
+  Amount fund_amount_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_CONTEXT_H_
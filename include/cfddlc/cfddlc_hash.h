@@ -0,0 +1,121 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_HASH_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_HASH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "cfdcore/cfdcore_bytedata.h"
+#include "cfddlc/cfddlc_common.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+
+/**
+ * @brief Hashing of many small independent messages at once. When the CPU
+ * supports AVX2, messages with the same number of blocks are hashed eight at
+ * a time, each one in a lane of the vector registers. Otherwise (or when
+ * use_simd is false) each message is hashed in turn by cfd-core.
+ *
+ */
+class CFD_DLC_EXPORT BatchHashUtil {
+ public:
+  /**
+   * @brief Compute the SHA256 hash of each message.
+   *
+   * @param messages the messages to hash.
+   * @param use_simd whether the vectorized implementation can be used.
+   * @return std::vector<ByteData256> the hash of each message.
+   */
+  static std::vector<ByteData256> Sha256(
+    const std::vector<std::vector<uint8_t>> &messages, bool use_simd = true);
+
+  /**
+   * @brief Compute the double SHA256 hash of each message.
+   *
+   * @param messages the messages to hash.
+   * @param use_simd whether the vectorized implementation can be used.
+   * @return std::vector<ByteData256> the hash of each message.
+   */
+  static std::vector<ByteData256> Sha256D(
+    const std::vector<std::vector<uint8_t>> &messages, bool use_simd = true);
+
+  /**
+   * @brief Compute the SHA256 hash of each message into a contiguous buffer,
+   * without allocating each hash separately.
+   *
+   * @param messages the messages to hash.
+   * @param use_simd whether the vectorized implementation can be used.
+   * @return std::vector<uint8_t> the 32 bytes hashes, in the order of the
+   * messages.
+   */
+  static std::vector<uint8_t> Sha256Digests(
+    const std::vector<std::vector<uint8_t>> &messages, bool use_simd = true);
+
+  /**
+   * @brief Check whether the vectorized implementation is supported by the
+   * CPU.
+   *
+   * @return true if messages can be hashed in parallel.
+   * @return false if they are hashed one at a time.
+   */
+  static bool IsSimdAvailable();
+};
+
+/**
+ * @brief SHA256 state after hashing a prefix made of whole blocks. Hashing a
+ * message starting with that prefix then only requires compressing the
+ * blocks of the rest of the message, e.g. a single block for a 32 bytes
+ * message following a 128 bytes prefix.
+ *
+ */
+class CFD_DLC_EXPORT Sha256Midstate {
+ public:
+  /**
+   * @brief Construct a new Sha256 Midstate object with an empty prefix.
+   *
+   */
+  Sha256Midstate();
+
+  /**
+   * @brief Append blocks to the prefix.
+   *
+   * @param blocks the data to append, whose size must be a multiple of 64.
+   * @throw CfdException if the size is not a multiple of 64.
+   */
+  void Write(const std::vector<uint8_t> &blocks);
+
+  /**
+   * @brief Compute the SHA256 hash of the prefix followed by some data. The
+   * midstate is not modified and can be reused.
+   *
+   * @param data the data following the prefix.
+   * @return ByteData256 the hash of the prefix and data.
+   */
+  ByteData256 Finalize(const std::vector<uint8_t> &data) const;
+
+  /**
+   * @brief Get the size of the prefix.
+   *
+   * @return uint64_t the number of bytes written.
+   */
+  uint64_t GetLength() const;
+
+ private:
+  /**
+   * @brief The hash state after the prefix.
+   */
+  uint32_t state_[8];
+  /**
+   * @brief The size of the prefix.
+   */
+  uint64_t length_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_HASH_H_
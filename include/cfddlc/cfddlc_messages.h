@@ -0,0 +1,136 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_MESSAGES_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_MESSAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cfdcore/cfdcore_bytedata.h"
+#include "cfddlc/cfddlc_common.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+
+/**
+ * @brief The oracle messages of a set of CETs, stored in a single contiguous
+ * buffer of 32 bytes hashes instead of one heap object per message. The
+ * messages of each CET are signed using the oracle nonces in order, so a CET
+ * can have fewer messages than the event has nonces (e.g. a digit prefix).
+ *
+ */
+class CFD_DLC_EXPORT CetMessageBuffer {
+ public:
+  /**
+   * @brief Size of a message.
+   */
+  static const size_t kMessageSize = 32;
+
+  /**
+   * @brief Construct a new empty Cet Message Buffer object.
+   *
+   */
+  CetMessageBuffer();
+
+  /**
+   * @brief Construct a new Cet Message Buffer object holding given messages.
+   *
+   * @param msgs the messages of each CET.
+   */
+  explicit CetMessageBuffer(const std::vector<std::vector<ByteData256>> &msgs);
+
+  /**
+   * @brief Create the messages of an enumerated outcome contract, the message
+   * of each CET being the SHA256 hash of its outcome. The outcomes are hashed
+   * in batches (see BatchHashUtil).
+   *
+   * @param outcomes the outcome of each CET.
+   * @param use_simd whether the vectorized hash implementation can be used.
+   * @return CetMessageBuffer the messages, one per CET.
+   */
+  static CetMessageBuffer FromOutcomes(
+    const std::vector<std::string> &outcomes, bool use_simd = true);
+
+  /**
+   * @brief Create the messages of a numeric outcome contract whose CETs cover
+   * digit prefixes. Only the messages of the digit values are hashed, and
+   * they are then copied for each digit of each prefix.
+   *
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @param digit_prefixes the digit prefix (most significant first) of each
+   * CET.
+   * @param digit_msgs the message signed by the oracle for each digit value
+   * (defaults to the hashes of the digits as decimal strings, see
+   * NumericOutcomeManager::GetDigitMessages).
+   * @return CetMessageBuffer the messages of each prefix.
+   * @throw CfdException if a prefix is empty, longer than nb_digits or has a
+   * digit out of the base.
+   */
+  static CetMessageBuffer FromDigitPrefixes(
+    uint32_t base,
+    uint32_t nb_digits,
+    const std::vector<std::vector<uint32_t>> &digit_prefixes,
+    const std::vector<ByteData256> &digit_msgs = std::vector<ByteData256>());
+
+  /**
+   * @brief Append the messages of a CET.
+   *
+   * @param msgs the nb_msgs concatenated messages of the CET.
+   * @param nb_msgs the number of messages.
+   */
+  void AddCet(const uint8_t *msgs, size_t nb_msgs);
+
+  /**
+   * @brief Get the number of CETs.
+   *
+   * @return size_t the number of CETs.
+   */
+  size_t GetCetCount() const;
+
+  /**
+   * @brief Get the number of messages of a CET.
+   *
+   * @param cet_index the index of the CET.
+   * @return size_t the number of messages.
+   */
+  size_t GetMessageCount(size_t cet_index) const;
+
+  /**
+   * @brief Get a message of a CET.
+   *
+   * @param cet_index the index of the CET.
+   * @param msg_index the index of the message within the CET.
+   * @return const uint8_t* the 32 bytes of the message, valid as long as the
+   * buffer is not modified.
+   */
+  const uint8_t *GetMessage(size_t cet_index, size_t msg_index) const;
+
+  /**
+   * @brief Get the messages of a CET as individual objects.
+   *
+   * @param cet_index the index of the CET.
+   * @return std::vector<ByteData256> the messages.
+   */
+  std::vector<ByteData256> GetMessages(size_t cet_index) const;
+
+ private:
+  /**
+   * @brief The concatenated messages of all the CETs.
+   */
+  std::vector<uint8_t> data_;
+  /**
+   * @brief The index of the first message of each CET, followed by the total
+   * number of messages.
+   */
+  std::vector<size_t> offsets_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_MESSAGES_H_
@@ -0,0 +1,227 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_NUMERIC_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_NUMERIC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cfdcore/cfdcore_bytedata.h"
+#include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_transactions.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+
+/**
+ * @brief A range of numeric outcomes sharing the same payout.
+ *
+ */
+struct CFD_DLC_EXPORT PayoutInterval {
+  /**
+   * @brief The first outcome of the interval.
+   *
+   */
+  uint64_t start;
+  /**
+   * @brief The last outcome of the interval (inclusive).
+   *
+   */
+  uint64_t end;
+  /**
+   * @brief The payout for all the outcomes of the interval.
+   *
+   */
+  DlcOutcome payout;
+};
+
+/**
+ * @brief A rounding modulus applying to the outcomes from begin_interval up to
+ * the begin_interval of the next rounding interval.
+ *
+ */
+struct CFD_DLC_EXPORT RoundingInterval {
+  /**
+   * @brief The first outcome to which the rounding applies.
+   *
+   */
+  uint64_t begin_interval;
+  /**
+   * @brief The modulus to which the local payout is rounded (1 for no
+   * rounding).
+   *
+   */
+  uint64_t rounding_mod;
+};
+
+/**
+ * @brief The CETs of a numeric outcome contract, each one covering all the
+ * outcomes starting with a given prefix of digits.
+ *
+ */
+struct CFD_DLC_EXPORT NumericOutcomeCets {
+  /**
+   * @brief The payout of each CET, to be given to CreateCets or
+   * CreateDlcTransactions.
+   *
+   */
+  std::vector<DlcOutcome> outcomes;
+  /**
+   * @brief The prefix of digits (most significant first) covered by each CET.
+   *
+   */
+  std::vector<std::vector<uint32_t>> digit_prefixes;
+  /**
+   * @brief The messages that the oracle signs for the prefix of each CET, to
+   * be given to CreateCetAdaptorSignatures.
+   *
+   */
+  std::vector<std::vector<ByteData256>> msgs;
+};
+
+/**
+ * @brief Helpers to build the CETs of contracts on a numeric outcome that the
+ * oracle attests digit by digit.
+ *
+ */
+class CFD_DLC_EXPORT NumericOutcomeManager {
+ public:
+  /**
+   * @brief Compute the minimal set of digit prefixes covering exactly the
+   * outcomes in [start, end]. As a CET needs at least one attested digit, a
+   * prefix is never empty.
+   *
+   * @param start the first outcome of the range.
+   * @param end the last outcome of the range (inclusive).
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @return std::vector<std::vector<uint32_t>> the prefixes, most significant
+   * digit first, in increasing order of the outcomes they cover.
+   */
+  static std::vector<std::vector<uint32_t>> ComputeCoveringPrefixes(
+    uint64_t start, uint64_t end, uint32_t base, uint32_t nb_digits);
+
+  /**
+   * @brief Create the CETs of a numeric outcome contract, using one CET per
+   * digit prefix instead of one CET per outcome. Adjacent intervals with the
+   * same payout are merged before computing the prefixes.
+   *
+   * @param intervals the payout intervals, sorted and covering every outcome
+   * from 0 to base^nb_digits - 1 without overlap.
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @param digit_msgs the message signed by the oracle for each digit value
+   * (defaults to the hashes of the digits as decimal strings, see
+   * GetDigitMessages).
+   * @return NumericOutcomeCets the payouts, prefixes and messages of the CETs.
+   */
+  static NumericOutcomeCets CreateNumericOutcomeCets(
+    const std::vector<PayoutInterval> &intervals,
+    uint32_t base,
+    uint32_t nb_digits,
+    const std::vector<ByteData256> &digit_msgs = std::vector<ByteData256>());
+
+  /**
+   * @brief Create the CETs of a numeric outcome contract after rounding the
+   * payouts (see RoundPayoutIntervals), so that ranges whose payouts only
+   * differ by a few satoshis share the same CETs.
+   *
+   * @param intervals the payout intervals, sorted and covering every outcome
+   * from 0 to base^nb_digits - 1 without overlap.
+   * @param rounding_intervals the rounding intervals, sorted by
+   * begin_interval, the first one beginning at 0.
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @param nb_removed_cets (out, optional) set to the number of CETs saved by
+   * the rounding. As the payout intervals are split at the beginning of each
+   * rounding interval, rounding can also add CETs, in which case it is
+   * negative.
+   * @param digit_msgs the message signed by the oracle for each digit value
+   * (defaults to GetDigitMessages).
+   * @return NumericOutcomeCets the payouts, prefixes and messages of the CETs.
+   */
+  static NumericOutcomeCets CreateNumericOutcomeCets(
+    const std::vector<PayoutInterval> &intervals,
+    const std::vector<RoundingInterval> &rounding_intervals,
+    uint32_t base,
+    uint32_t nb_digits,
+    int64_t *nb_removed_cets = nullptr,
+    const std::vector<ByteData256> &digit_msgs = std::vector<ByteData256>());
+
+  /**
+   * @brief Round the local payout of each outcome to the nearest multiple of
+   * the rounding modulus applying to it (clamped to the total collateral),
+   * and merge the adjacent intervals ending up with the same payout.
+   * Intervals crossing the beginning of a rounding interval are split.
+   *
+   * @param intervals the payout intervals, sorted and contiguous.
+   * @param rounding_intervals the rounding intervals, sorted by
+   * begin_interval, the first one beginning at 0.
+   * @return std::vector<PayoutInterval> the rounded payout intervals.
+   */
+  static std::vector<PayoutInterval> RoundPayoutIntervals(
+    const std::vector<PayoutInterval> &intervals,
+    const std::vector<RoundingInterval> &rounding_intervals);
+
+  /**
+   * @brief Get the messages signed by the oracle for each digit value, being
+   * the SHA256 hash of the digit as a decimal string.
+   *
+   * @param base the base in which the outcome is decomposed.
+   * @return std::vector<ByteData256> the message of each digit value.
+   */
+  static std::vector<ByteData256> GetDigitMessages(uint32_t base);
+
+  /**
+   * @brief Get the messages to sign for a set of digit prefixes.
+   *
+   * @param digit_prefixes the digit prefixes.
+   * @param digit_msgs the message signed by the oracle for each digit value.
+   * @return std::vector<std::vector<ByteData256>> the messages of each prefix.
+   */
+  static std::vector<std::vector<ByteData256>> GetPrefixMessages(
+    const std::vector<std::vector<uint32_t>> &digit_prefixes,
+    const std::vector<ByteData256> &digit_msgs);
+
+  /**
+   * @brief Decompose an outcome in digits.
+   *
+   * @param outcome the outcome value.
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @return std::vector<uint32_t> the digits, most significant first.
+   */
+  static std::vector<uint32_t> DecomposeOutcome(
+    uint64_t outcome, uint32_t base, uint32_t nb_digits);
+
+  /**
+   * @brief Get the number of outcomes that can be represented, being
+   * base^nb_digits.
+   *
+   * @param base the base in which the outcome is decomposed.
+   * @param nb_digits the number of digits of the outcome.
+   * @return uint64_t the number of outcomes.
+   * @throw CfdException if the base is lower than 2, if nb_digits is 0 or if
+   * the number of outcomes does not fit in 64 bits.
+   */
+  static uint64_t GetOutcomeCount(uint32_t base, uint32_t nb_digits);
+
+ private:
+  /**
+   * @brief Check that payout intervals are sorted and contiguous, and merge
+   * the adjacent ones having the same payout.
+   *
+   * @param intervals the payout intervals.
+   * @return std::vector<PayoutInterval> the merged intervals.
+   */
+  static std::vector<PayoutInterval> MergePayoutIntervals(
+    const std::vector<PayoutInterval> &intervals);
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_NUMERIC_H_
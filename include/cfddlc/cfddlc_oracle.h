@@ -0,0 +1,325 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_ORACLE_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_ORACLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cfdcore/cfdcore_key.h"
+#include "cfdcore/cfdcore_schnorrsig.h"
+#include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_hash.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+
+/**
+ * @brief Fixed-base multiplication table of an oracle public key P, holding
+ * d * 16^i * P for every 4 bits window i of a scalar and every non zero
+ * digit d. Multiplying P by a scalar then only requires adding one table
+ * entry per non zero window, instead of a variable-base multiplication. The
+ * table takes about 60KB and a thousand point additions to build, so it is
+ * meant to be shared (e.g. by all the contracts using the same oracle). As
+ * the table lookups depend on the scalar, it must only be used with public
+ * scalars such as BIP340 challenges. The table is immutable and can be
+ * shared between threads.
+ *
+ */
+class CFD_DLC_EXPORT OraclePubkeyTable {
+ public:
+  /**
+   * @brief Construct a new Oracle Pubkey Table object.
+   *
+   * @param oracle_pubkey the pubkey of the oracle.
+   */
+  explicit OraclePubkeyTable(const SchnorrPubkey &oracle_pubkey);
+
+  /**
+   * @brief Get the pubkey of the oracle.
+   *
+   * @return const SchnorrPubkey& the oracle pubkey.
+   */
+  const SchnorrPubkey &GetOraclePubkey() const;
+
+  /**
+   * @brief Multiply the oracle pubkey (with even y coordinate) by a scalar.
+   *
+   * @param scalar the public scalar, big endian.
+   * @return Pubkey the point scalar * P.
+   * @throw CfdException if the result is the point at infinity.
+   */
+  Pubkey Multiply(const ByteData256 &scalar) const;
+
+ private:
+  /**
+   * @brief The oracle pubkey.
+   */
+  SchnorrPubkey oracle_pubkey_;
+  /**
+   * @brief The parsed points of the table (64 bytes each), indexed by
+   * window * 15 + digit - 1.
+   */
+  std::vector<uint8_t> points_;
+
+  /**
+   * @brief Multiply the oracle pubkey by a scalar, without serializing the
+   * product.
+   *
+   * @param scalar the public scalar, big endian.
+   * @param point (out) the 64 bytes parsed point scalar * P.
+   */
+  void MultiplyPoint(const ByteData256 &scalar, uint8_t *point) const;
+
+  friend class OracleNonceContext;
+};
+
+/**
+ * @brief The parts of the BIP340 challenges e = H_tag(R || P || m) of an
+ * oracle event that do not depend on the message. For each nonce, the
+ * SHA256 midstate after the tag prefix and the 64 bytes R || P block is
+ * computed once, so that the challenge of a message only costs the
+ * compression of a single block. The lifted nonce and oracle points are kept
+ * as well, so that signature points are computed without parsing any key.
+ * The context is immutable and can be shared between threads.
+ *
+ */
+class CFD_DLC_EXPORT OracleNonceContext {
+ public:
+  /**
+   * @brief Construct a new Oracle Nonce Context object.
+   *
+   * @param oracle_pubkey the pubkey of the oracle for the event.
+   * @param oracle_r_values the r values that the oracle will use for the
+   * event.
+   */
+  OracleNonceContext(
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values);
+
+  /**
+   * @brief Construct a new Oracle Nonce Context object multiplying the
+   * oracle pubkey with a precomputed table.
+   *
+   * @param pubkey_table the multiplication table of the oracle pubkey.
+   * @param oracle_r_values the r values that the oracle will use for the
+   * event.
+   */
+  OracleNonceContext(
+    const std::shared_ptr<const OraclePubkeyTable> &pubkey_table,
+    const std::vector<SchnorrPubkey> &oracle_r_values);
+
+  /**
+   * @brief Get the pubkey of the oracle.
+   *
+   * @return const SchnorrPubkey& the oracle pubkey.
+   */
+  const SchnorrPubkey &GetOraclePubkey() const;
+
+  /**
+   * @brief Get the r values of the event.
+   *
+   * @return const std::vector<SchnorrPubkey>& the r values.
+   */
+  const std::vector<SchnorrPubkey> &GetOracleRValues() const;
+
+  /**
+   * @brief Get the number of nonces of the event.
+   *
+   * @return size_t the number of nonces.
+   */
+  size_t GetNonceCount() const;
+
+  /**
+   * @brief Compute the challenge of a nonce for a given message.
+   *
+   * @param nonce_index the index of the nonce.
+   * @param msg the message.
+   * @return ByteData256 the challenge, reduced modulo the curve order.
+   */
+  ByteData256 ComputeChallenge(
+    size_t nonce_index, const ByteData256 &msg) const;
+
+  /**
+   * @brief Compute the signature point R + e * P of a nonce for a given
+   * message.
+   *
+   * @param nonce_index the index of the nonce.
+   * @param msg the message.
+   * @return Pubkey the signature point.
+   */
+  Pubkey ComputeSigPoint(size_t nonce_index, const ByteData256 &msg) const;
+
+  /**
+   * @brief Compute the adaptor point for an outcome, the i-th message being
+   * signed using the i-th nonce. The sum of the signature points is computed
+   * as sum(R_i) + (sum e_i) * P, with a single scalar multiplication.
+   *
+   * @param msgs the messages of the outcome.
+   * @return Pubkey the sum of the signature points of the messages.
+   */
+  Pubkey ComputeAdaptorPoint(const std::vector<ByteData256> &msgs) const;
+
+ private:
+  /**
+   * @brief The oracle pubkey.
+   */
+  SchnorrPubkey oracle_pubkey_;
+  /**
+   * @brief The r values of the event.
+   */
+  std::vector<SchnorrPubkey> oracle_r_values_;
+  /**
+   * @brief The oracle pubkey followed by the r values, as points with even y
+   * coordinate parsed once (64 bytes each) so that computing a signature
+   * point does not decompress them again.
+   */
+  std::vector<uint8_t> parsed_points_;
+  /**
+   * @brief The challenge hash midstate of each nonce, after the tag prefix
+   * and R || P.
+   */
+  std::vector<Sha256Midstate> challenge_midstates_;
+  /**
+   * @brief The multiplication table of the oracle pubkey, if any.
+   */
+  std::shared_ptr<const OraclePubkeyTable> pubkey_table_;
+
+  /**
+   * @brief Multiply the oracle pubkey by a challenge or a sum of challenges.
+   *
+   * @param scalar the scalar.
+   * @param point (out) the 64 bytes parsed point scalar * P.
+   */
+  void MultiplyOraclePoint(const ByteData256 &scalar, uint8_t *point) const;
+};
+
+/**
+ * @brief Table of the signature points of every (nonce, message) pair of an
+ * oracle event whose nonces can only sign a small set of messages (e.g. the
+ * digits of a numeric outcome). Once built, the adaptor point of an outcome
+ * is obtained by adding the signature points of its messages, without any
+ * hashing or scalar multiplication. The table is immutable and can be shared
+ * between threads.
+ *
+ */
+class CFD_DLC_EXPORT OracleEventPointTable {
+ public:
+  /**
+   * @brief Construct a new Oracle Event Point Table object.
+   *
+   * @param oracle_pubkey the pubkey of the oracle for the event.
+   * @param oracle_r_values the r values that the oracle will use for the
+   * event.
+   * @param digit_msgs the messages that each nonce can sign (e.g. the hashes
+   * of "0" and "1" for a base 2 decomposition).
+   */
+  OracleEventPointTable(
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const std::vector<ByteData256> &digit_msgs);
+
+  /**
+   * @brief Construct a new Oracle Event Point Table object from the nonce
+   * context of the event (e.g. one using an oracle pubkey table).
+   *
+   * @param nonce_context the nonce context of the event.
+   * @param digit_msgs the messages that each nonce can sign.
+   */
+  OracleEventPointTable(
+    const OracleNonceContext &nonce_context,
+    const std::vector<ByteData256> &digit_msgs);
+
+  /**
+   * @brief Get the pubkey of the oracle.
+   *
+   * @return const SchnorrPubkey& the oracle pubkey.
+   */
+  const SchnorrPubkey &GetOraclePubkey() const;
+
+  /**
+   * @brief Get the r values of the event.
+   *
+   * @return const std::vector<SchnorrPubkey>& the r values.
+   */
+  const std::vector<SchnorrPubkey> &GetOracleRValues() const;
+
+  /**
+   * @brief Get the number of nonces of the event.
+   *
+   * @return size_t the number of nonces.
+   */
+  size_t GetNonceCount() const;
+
+  /**
+   * @brief Get the number of messages each nonce can sign.
+   *
+   * @return size_t the number of messages.
+   */
+  size_t GetDigitCount() const;
+
+  /**
+   * @brief Get the index of a message in the digit messages.
+   *
+   * @param msg the message to look for.
+   * @return size_t the index of the message.
+   * @throw CfdException if the message is not part of the table.
+   */
+  size_t GetDigitIndex(const ByteData256 &msg) const;
+
+  /**
+   * @brief Get the signature point of a nonce for a given message.
+   *
+   * @param nonce_index the index of the nonce.
+   * @param digit_index the index of the message in the digit messages.
+   * @return const Pubkey& the signature point.
+   */
+  const Pubkey &GetSigPoint(size_t nonce_index, size_t digit_index) const;
+
+  /**
+   * @brief Compute the adaptor point for an outcome, the i-th message being
+   * signed using the i-th nonce.
+   *
+   * @param msgs the messages of the outcome.
+   * @return Pubkey the sum of the signature points of the messages.
+   */
+  Pubkey ComputeAdaptorPoint(const std::vector<ByteData256> &msgs) const;
+
+  /**
+   * @brief Compute the adaptor point for an outcome given as indexes in the
+   * digit messages, the i-th digit being signed using the i-th nonce.
+   *
+   * @param digit_indexes the indexes of the messages of the outcome.
+   * @return Pubkey the sum of the signature points of the messages.
+   */
+  Pubkey ComputeAdaptorPoint(const std::vector<size_t> &digit_indexes) const;
+
+ private:
+  /**
+   * @brief The oracle pubkey.
+   */
+  SchnorrPubkey oracle_pubkey_;
+  /**
+   * @brief The r values of the event.
+   */
+  std::vector<SchnorrPubkey> oracle_r_values_;
+  /**
+   * @brief The serialized digit messages.
+   */
+  std::vector<std::vector<uint8_t>> digit_msgs_;
+  /**
+   * @brief The signature points, indexed by nonce_index * digit count +
+   * digit_index.
+   */
+  std::vector<Pubkey> sig_points_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_ORACLE_H_
@@ -0,0 +1,150 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_PAYOUT_CURVE_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_PAYOUT_CURVE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_numeric.h"
+#include "cfddlc/cfddlc_transactions.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::Amount;
+
+/**
+ * @brief The type of function of a payout curve piece.
+ *
+ */
+enum PayoutCurvePieceType {
+  /**
+   * @brief payout = c0 + c1 * t + c2 * t^2 + ..., with t = outcome - start.
+   */
+  kPayoutPolynomial = 0,
+  /**
+   * @brief payout = a + b / (outcome - c), with coefficients {a, b, c}.
+   */
+  kPayoutHyperbola = 1,
+};
+
+/**
+ * @brief A piece of a payout curve, giving the local payout for the outcomes
+ * from start to end.
+ *
+ */
+struct CFD_DLC_EXPORT PayoutCurvePiece {
+  /**
+   * @brief The type of function of the piece.
+   *
+   */
+  PayoutCurvePieceType type;
+  /**
+   * @brief The first outcome of the piece.
+   *
+   */
+  uint64_t start;
+  /**
+   * @brief The last outcome of the piece (inclusive).
+   *
+   */
+  uint64_t end;
+  /**
+   * @brief The coefficients of the function (see PayoutCurvePieceType).
+   *
+   */
+  std::vector<double> coefficients;
+};
+
+/**
+ * @brief A piecewise payout function over a range of numeric outcomes. The
+ * pieces are evaluated by blocks of outcomes in branch free loops that the
+ * compiler can vectorize, and the resulting local payouts are rounded to the
+ * satoshi and clamped to the total collateral, so that the produced outcomes
+ * are always valid.
+ *
+ */
+class CFD_DLC_EXPORT PayoutCurve {
+ public:
+  /**
+   * @brief Construct a new Payout Curve object.
+   *
+   * @param pieces the pieces of the curve, sorted and contiguous.
+   */
+  explicit PayoutCurve(const std::vector<PayoutCurvePiece> &pieces);
+
+  /**
+   * @brief Create a linear piece going through two points.
+   *
+   * @param start the first outcome of the piece.
+   * @param start_payout the local payout at start.
+   * @param end the last outcome of the piece.
+   * @param end_payout the local payout at end.
+   * @return PayoutCurvePiece the piece.
+   */
+  static PayoutCurvePiece CreateLinearPiece(
+    uint64_t start, int64_t start_payout, uint64_t end, int64_t end_payout);
+
+  /**
+   * @brief Get the first outcome of the curve.
+   *
+   * @return uint64_t the first outcome.
+   */
+  uint64_t GetStart() const;
+
+  /**
+   * @brief Get the last outcome of the curve.
+   *
+   * @return uint64_t the last outcome.
+   */
+  uint64_t GetEnd() const;
+
+  /**
+   * @brief Compute the local payouts of the outcomes from start to end.
+   *
+   * @param start the first outcome.
+   * @param end the last outcome (inclusive).
+   * @param total_collateral the total collateral of the contract.
+   * @param local_payouts (out) the end - start + 1 local payouts, in satoshi.
+   */
+  void ComputeLocalPayouts(
+    uint64_t start,
+    uint64_t end,
+    const Amount &total_collateral,
+    int64_t *local_payouts) const;
+
+  /**
+   * @brief Compute the outcome of every point of the curve, to be given to
+   * CreateDlcTransactions or CreateCets.
+   *
+   * @param total_collateral the total collateral of the contract.
+   * @return std::vector<DlcOutcome> the outcomes, from GetStart to GetEnd.
+   */
+  std::vector<DlcOutcome> ComputeOutcomes(
+    const Amount &total_collateral) const;
+
+  /**
+   * @brief Compute the payout intervals of the curve, merging the consecutive
+   * outcomes having the same payout, to be given to
+   * NumericOutcomeManager::CreateNumericOutcomeCets.
+   *
+   * @param total_collateral the total collateral of the contract.
+   * @return std::vector<PayoutInterval> the payout intervals.
+   */
+  std::vector<PayoutInterval> ComputePayoutIntervals(
+    const Amount &total_collateral) const;
+
+ private:
+  /**
+   * @brief The pieces of the curve.
+   */
+  std::vector<PayoutCurvePiece> pieces_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_PAYOUT_CURVE_H_
@@ -0,0 +1,109 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_POINT_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_POINT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "cfdcore/cfdcore_key.h"
+#include "cfddlc/cfddlc_common.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::Pubkey;
+
+/**
+ * @brief A secp256k1 point in Jacobian coordinates (X, Y, Z), standing for
+ * the affine point (X / Z^2, Y / Z^3). Points can be added without any field
+ * inversion, which is only needed when converting back to a Pubkey. Many
+ * points can be converted together with a single inversion (Montgomery's
+ * trick, see ToPubkeys), e.g. the adaptor points of all the CETs of a
+ * contract. The point coordinates are public, so the arithmetic is not
+ * constant time.
+ *
+ */
+class CFD_DLC_EXPORT JacobianPoint {
+ public:
+  /**
+   * @brief Construct a new Jacobian Point object at infinity.
+   *
+   */
+  JacobianPoint();
+
+  /**
+   * @brief Construct a new Jacobian Point object from a public key.
+   *
+   * @param pubkey the public key.
+   * @throw CfdException if the public key is invalid.
+   */
+  explicit JacobianPoint(const Pubkey &pubkey);
+
+  /**
+   * @brief Check whether the point is the point at infinity.
+   *
+   * @return true if the point is at infinity.
+   * @return false otherwise.
+   */
+  bool IsInfinity() const;
+
+  /**
+   * @brief Add a point. Adding a point that came from a public key (with Z
+   * equal to 1) is cheaper than adding a sum.
+   *
+   * @param point the point to add.
+   * @return JacobianPoint the sum of the points.
+   */
+  JacobianPoint Add(const JacobianPoint &point) const;
+
+  /**
+   * @brief Convert the point to a public key.
+   *
+   * @return Pubkey the public key.
+   * @throw CfdException if the point is at infinity.
+   */
+  Pubkey ToPubkey() const;
+
+  /**
+   * @brief Convert a set of points to public keys using a single field
+   * inversion.
+   *
+   * @param points the points to convert.
+   * @param is_compressed whether to use the compressed encoding (the
+   * uncompressed one can be parsed without computing a square root).
+   * @return std::vector<Pubkey> the public key of each point.
+   * @throw CfdException if a point is at infinity.
+   */
+  static std::vector<Pubkey> ToPubkeys(
+    const std::vector<JacobianPoint> &points, bool is_compressed = true);
+
+ private:
+  /**
+   * @brief The coordinates, as little endian 64 bit limbs reduced modulo the
+   * field prime.
+   */
+  uint64_t x_[4];
+  uint64_t y_[4];
+  uint64_t z_[4];
+  /**
+   * @brief Whether the point is at infinity.
+   */
+  bool infinity_;
+  /**
+   * @brief Whether Z is known to be 1 (i.e. X and Y are affine).
+   */
+  bool affine_;
+
+  /**
+   * @brief Double the point.
+   *
+   * @return JacobianPoint the point times 2.
+   */
+  JacobianPoint Double() const;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_POINT_H_
@@ -0,0 +1,270 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_STREAM_H_
+#define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_messages.h"
+#include "cfddlc/cfddlc_oracle.h"
+#include "cfddlc/cfddlc_transactions.h"
+
+namespace cfd {
+namespace dlc {
+
+/**
+ * @brief The parameters shared by all the CETs of a contract, from which a
+ * CET can be rebuilt given its outcome.
+ *
+ */
+struct CFD_DLC_EXPORT CetTransactionParams {
+  /**
+   * @brief The tx id of the fund transaction.
+   *
+   */
+  Txid fund_tx_id;
+  /**
+   * @brief The vout of the fund output.
+   *
+   */
+  uint32_t fund_vout;
+  /**
+   * @brief The script for the local payout output.
+   *
+   */
+  Script local_final_script_pubkey;
+  /**
+   * @brief The script for the remote payout output.
+   *
+   */
+  Script remote_final_script_pubkey;
+  /**
+   * @brief The script pubkey of the fund output.
+   *
+   */
+  Script funding_script_pubkey;
+  /**
+   * @brief The value of the fund output.
+   *
+   */
+  Amount fund_output_amount;
+  /**
+   * @brief The lock time of the CETs.
+   *
+   */
+  uint32_t lock_time;
+  /**
+   * @brief The serial id of the local payout output.
+   *
+   */
+  uint64_t local_serial_id;
+  /**
+   * @brief The serial id of the remote payout output.
+   *
+   */
+  uint64_t remote_serial_id;
+};
+
+/**
+ * @brief Source of outcomes to sign. It is given the maximum number of
+ * outcomes to provide and appends to the (empty) vectors the payouts and the
+ * oracle messages of the next outcomes. Leaving them empty ends the stream.
+ *
+ */
+using CetOutcomeSource = std::function<void(
+  size_t max_count,
+  std::vector<DlcOutcome> *outcomes,
+  std::vector<std::vector<ByteData256>> *msgs)>;
+
+/**
+ * @brief Sink receiving the adaptor signatures of consecutive CETs, the first
+ * one being the CET of index first_index in the stream. The signatures are
+ * only valid during the call.
+ *
+ */
+using AdaptorPairSink = std::function<void(
+  size_t first_index, const std::vector<AdaptorPair> &adaptor_pairs)>;
+
+/**
+ * @brief Creates the CET adaptor signatures of a contract chunk by chunk, so
+ * that the memory used only depends on the chunk size and not on the number
+ * of outcomes. The CETs of each chunk of outcomes read from the source are
+ * signed from their signature hashes, without building the transactions, and
+ * the signatures are handed to the sink before the next chunk is read. The
+ * oracle nonce context is built once for all the chunks.
+ *
+ */
+class CFD_DLC_EXPORT StreamingCetSigner {
+ public:
+  /**
+   * @brief Construct a new Streaming Cet Signer object.
+   *
+   * @param params the parameters of the CETs.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r values that the oracle will use for
+   * the associated event.
+   * @param funding_sk the private key to generate the signatures with.
+   * @param chunk_size the maximum number of CETs held in memory at once.
+   * @param nb_threads the number of worker threads signing each chunk (0 to
+   * use the number of hardware threads).
+   */
+  StreamingCetSigner(
+    const CetTransactionParams &params,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &funding_sk,
+    size_t chunk_size = 1024,
+    uint32_t nb_threads = 1);
+
+  /**
+   * @brief Sign all the outcomes provided by a source.
+   *
+   * @param source the source of the outcomes.
+   * @param sink the sink receiving the adaptor signatures, in the order of
+   * the outcomes.
+   * @return size_t the number of CETs signed.
+   */
+  size_t Sign(const CetOutcomeSource &source, const AdaptorPairSink &sink);
+
+ private:
+  /**
+   * @brief The signature hasher of the CETs.
+   */
+  CetSignatureHasher sig_hasher_;
+  /**
+   * @brief The nonce context of the oracle event, shared by all the chunks.
+   */
+  OracleNonceContext nonce_context_;
+  /**
+   * @brief The private key used to sign.
+   */
+  Privkey funding_sk_;
+  /**
+   * @brief The maximum number of CETs per chunk.
+   */
+  size_t chunk_size_;
+  /**
+   * @brief The number of worker threads.
+   */
+  uint32_t nb_threads_;
+  /**
+   * @brief The outcomes of the current chunk.
+   */
+  std::vector<DlcOutcome> outcomes_;
+  /**
+   * @brief The messages of the current chunk.
+   */
+  std::vector<std::vector<ByteData256>> msgs_;
+};
+
+/**
+ * @brief Verifies the CET adaptor signatures of a counterparty as they are
+ * received. Each chunk of signatures is checked as soon as it is added,
+ * against the signature hashes of the CETs derived from the contract
+ * outcomes, so that verification overlaps with the reception of the rest of
+ * the message, and once the last chunk has been added the verdict is
+ * available without further work. The oracle nonce context and the messages
+ * are prepared once for all the chunks. Verification stops at the first invalid
+ * signature.
+ *
+ */
+class CFD_DLC_EXPORT CetSignatureVerifier {
+ public:
+  /**
+   * @brief Construct a new Cet Signature Verifier object.
+   *
+   * @param params the parameters of the CETs.
+   * @param pubkey the public key to verify the signatures against.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r values that the oracle will use for
+   * the associated event.
+   * @param outcomes the payouts of the CETs, in the order in which their
+   * signatures are received.
+   * @param msgs the oracle messages of the CETs.
+   * @param nb_threads the number of worker threads verifying each chunk (0 to
+   * use the number of hardware threads).
+   */
+  CetSignatureVerifier(
+    const CetTransactionParams &params,
+    const Pubkey &pubkey,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const std::vector<DlcOutcome> &outcomes,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    uint32_t nb_threads = 1);
+
+  /**
+   * @brief Verify the next signatures of the stream. Nothing is checked once
+   * an invalid signature has been found.
+   *
+   * @param adaptor_pairs the signatures of the CETs following the ones
+   * already added.
+   * @return true if all the signatures added so far are valid.
+   * @return false otherwise.
+   * @throw CfdException if there are more signatures than CETs.
+   */
+  bool AddSignatures(const std::vector<AdaptorPair> &adaptor_pairs);
+
+  /**
+   * @brief Get the number of signatures added so far.
+   *
+   * @return size_t the number of signatures.
+   */
+  size_t GetReceivedCount() const;
+
+  /**
+   * @brief Give the final verdict once all signatures have been added.
+   *
+   * @param invalid_index (out, optional) set to the index of the first
+   * invalid or missing signature, or to the number of CETs if there is none.
+   * @return true if a valid signature has been added for every CET.
+   * @return false if a signature is invalid or missing.
+   */
+  bool Finalize(size_t *invalid_index = nullptr) const;
+
+ private:
+  /**
+   * @brief The signature hasher of the CETs.
+   */
+  CetSignatureHasher sig_hasher_;
+  /**
+   * @brief The public key to verify the signatures against.
+   */
+  Pubkey pubkey_;
+  /**
+   * @brief The nonce context of the oracle event, shared by all the chunks.
+   * It is the verification one (see
+   * DlcManager::CreateVerificationNonceContext), chosen from the number of
+   * CETs of the whole contract rather than of a chunk.
+   */
+  OracleNonceContext nonce_context_;
+  /**
+   * @brief The payouts of the CETs.
+   */
+  std::vector<DlcOutcome> outcomes_;
+  /**
+   * @brief The oracle messages of the CETs.
+   */
+  CetMessageBuffer msgs_;
+  /**
+   * @brief The number of worker threads.
+   */
+  uint32_t nb_threads_;
+  /**
+   * @brief The number of signatures added so far.
+   */
+  size_t nb_received_;
+  /**
+   * @brief The index of the first invalid signature, or the number of CETs.
+   */
+  size_t invalid_index_;
+};
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_INCLUDE_CFDDLC_CFDDLC_STREAM_H_
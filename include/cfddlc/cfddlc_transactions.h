@@ -3,6 +3,7 @@
 #ifndef CFD_DLC_INCLUDE_CFDDLC_CFDDLC_TRANSACTIONS_H_
 #define CFD_DLC_INCLUDE_CFDDLC_CFDDLC_TRANSACTIONS_H_
 
+#include <functional>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -13,6 +14,9 @@
 #include "cfdcore/cfdcore_hdwallet.h"
 #include "cfdcore/cfdcore_schnorrsig.h"
 #include "cfddlc/cfddlc_common.h"
+#include "cfddlc/cfddlc_context.h"
+#include "cfddlc/cfddlc_messages.h"
+#include "cfddlc/cfddlc_oracle.h"
 
 namespace cfd {
 namespace dlc {
@@ -187,6 +191,16 @@ struct BatchPartyParams {
   uint64_t change_serial_id;
 };
 
+/**
+ * @brief Callback receiving a CET together with the index of its outcome.
+ * The CET is only valid during the call.
+ *
+ */
+using CetHandler =
+  std::function<void(size_t index, const TransactionController &cet)>;
+
+class CetSignatureHasher;
+
 /**
  * @brief Class providing utility functions to create DLC transactions.
  *
@@ -227,7 +241,31 @@ class CFD_DLC_EXPORT DlcManager {
     const uint32_t fund_vout,
     const Script &local_final_script_pubkey,
     const Script &remote_final_script_pubkey,
-    const std::vector<DlcOutcome> outcomes,
+    const std::vector<DlcOutcome> &outcomes,
+    uint32_t lock_time = 0,
+    uint64_t local_serial_id = 0,
+    uint64_t remote_serial_id = 0);
+
+  /**
+   * @brief Create the CETs one at a time, passing each of them to a handler
+   * instead of returning them all at once, so that the memory used does not
+   * depend on the number of outcomes.
+   *
+   * @param fund_tx_id the tx id of the funding transaction
+   * @param fund_vout the vout of the fund output
+   * @param local_final_script_pubkey the script for the local payout output.
+   * @param remote_final_script_pubkey the script for the remote payout output.
+   * @param outcomes the list of possible payouts, one for each possible outcome
+   * @param cet_handler the handler called with each CET, in outcome order.
+   * @param lock_time lock time (optional)
+   */
+  static void CreateCets(
+    const Txid &fund_tx_id,
+    const uint32_t fund_vout,
+    const Script &local_final_script_pubkey,
+    const Script &remote_final_script_pubkey,
+    const std::vector<DlcOutcome> &outcomes,
+    const CetHandler &cet_handler,
     uint32_t lock_time = 0,
     uint64_t local_serial_id = 0,
     uint64_t remote_serial_id = 0);
@@ -394,7 +432,10 @@ class CFD_DLC_EXPORT DlcManager {
     const std::vector<ByteData256> &msgs);
 
   /**
-   * @brief Create a Cet Adaptor Signatures object
+   * @brief Create a Cet Adaptor Signatures object. With several worker
+   * threads, the CETs are split in contiguous chunks that are signed
+   * concurrently, and the result is identical (same order and same bytes) to
+   * the one of a single thread.
    *
    * @param cets the cets to generate adaptor signatures for.
    * @param oracle_pubkey the pubkey of the oracle for the associated event.
@@ -404,6 +445,8 @@ class CFD_DLC_EXPORT DlcManager {
    * @param funding_script_pubkey the script pubkey of the fund output.
    * @param fund_output_amount the value of the fund output.
    * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
    * @return std::vector<AdaptorPair> a set of signature together with their
    * DLEq proofs.
    */
@@ -414,7 +457,8 @@ class CFD_DLC_EXPORT DlcManager {
     const Privkey &funding_sk,
     const Script &funding_script_pubkey,
     const Amount &fund_output_amount,
-    const std::vector<std::vector<ByteData256>> &msgs);
+    const std::vector<std::vector<ByteData256>> &msgs,
+    uint32_t nb_threads = 1);
 
   /**
    * @brief Verify that a signature for a fund transaction is valid.
@@ -489,7 +533,37 @@ class CFD_DLC_EXPORT DlcManager {
     const Amount &fund_output_amount);
 
   /**
-   * @brief
+   * @brief Sign a CET transaction (see SignCet) with the funding private key
+   * of a crypto context, whose public key and position in the multisig
+   * script are not derived again. The fund output must be locked by the
+   * multisig script of the fund pubkeys of the context.
+   *
+   * @param cet the CET to which the signatures will be added.
+   * @param adaptor_sig the adaptor signature of the counterparty.
+   * @param oracle_signatures the set of signatures from the oracle over the
+   * corresponding event outcome.
+   * @param context the crypto context of the contract.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_tx_id the transaction id of the fund transactions.
+   * @param fund_vout the vout of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   */
+  static void SignCet(
+    TransactionController *cet,
+    const AdaptorSignature &adaptor_sig,
+    const std::vector<SchnorrSignature> &oracle_signatures,
+    const DlcCryptoContext &context,
+    const Script &funding_script_pubkey,
+    const Txid &fund_tx_id,
+    uint32_t fund_vout,
+    const Amount &fund_output_amount);
+
+  /**
+   * @brief Verify a set of CET adaptor signatures, and report the position
+   * of the first invalid one. The workers verify the CETs by blocks,
+   * computing the adaptor points of a block before verifying its signatures,
+   * and as soon as one worker finds an invalid signature, all workers stop
+   * once their current block is done.
    *
    * @param cets the transactions to verify the signatures against.
    * @param signature_and_proofs the adaptor signatures and their proofs to
@@ -502,8 +576,12 @@ class CFD_DLC_EXPORT DlcManager {
    * signature over the outcome of the associated event.
    * @param funding_script_pubkey the script pubkey of the fund output.
    * @param fund_output_amount the value of the fund output.
-   * @return true
-   * @return false
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
    */
   static bool VerifyCetAdaptorSignatures(
     const std::vector<TransactionController> &cets,
@@ -513,153 +591,770 @@ class CFD_DLC_EXPORT DlcManager {
     const SchnorrPubkey &oracle_pubkey,
     const std::vector<SchnorrPubkey> &oracle_r_value,
     const Script &funding_script_pubkey,
-    const Amount &fund_output_amount);
+    const Amount &fund_output_amount,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
 
   /**
-   * @brief Get the Raw Refund Tx Signature object
+   * @brief Create an Adaptor Signature for a given cet, using a precomputed
+   * oracle event point table in place of the oracle r values.
    *
-   * @param refund_tx transaction for which to produce a signature.
-   * @param privkey the private key to produce the signature.
-   * @param fund_lockscript the locking script of the fund transaction
-   * output.
-   * @param input_amount the amount locked in the fund transaction output.
-   * @param fund_tx_id the id of the fund transaction.
-   * @param fund_vout the vout of the fund transaction output (defaults to
-   * 0).
-   * @return ByteData the produced raw signature.
+   * @param cet the CET to generate the signature for.
+   * @param point_table the signature points of the oracle event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   * @param msgs the set of messages for the outcome corresponding to the given
+   * CET.
+   * @return AdaptorPair an adaptor signature and its dleq proof.
    */
-  static ByteData GetRawRefundTxSignature(
-    const TransactionController &refund_tx,
-    const Privkey &privkey,
-    const Script &fund_lockscript,
-    const Amount &input_amount,
-    const Txid &fund_tx_id,
-    const uint32_t fund_vout = 0);
+  static AdaptorPair CreateCetAdaptorSignature(
+    const TransactionController &cet,
+    const OracleEventPointTable &point_table,
+    const Privkey &funding_sk,
+    const Script &funding_script_pubkey,
+    const Amount &fund_output_amount,
+    const std::vector<ByteData256> &msgs);
 
   /**
-   * @brief Get the Raw Refund Tx Signature object
+   * @brief Create adaptor signatures for a set of CETs, using a precomputed
+   * oracle event point table in place of the oracle r values.
    *
-   * @param refund_tx transaction for which to produce a signature.
-   * @param privkey the private key to produce the signature.
-   * @param local_fund_pubkey the fund public key of local party.
-   * @param remote_fund_pubkey the fund public key of remote party.
-   * @param input_amount the amount locked in the fund transaction output.
-   * @param fund_tx_id the id of the fund transaction.
-   * @param fund_vout the vout of the fund transaction output (defaults to
-   * 0).
-   * @return ByteData the produced raw signature.
+   * @param cets the cets to generate adaptor signatures for.
+   * @param point_table the signature points of the oracle event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
    */
-  static ByteData GetRawRefundTxSignature(
-    const TransactionController &refund_tx,
-    const Privkey &privkey,
-    const Pubkey &local_fund_pubkey,
-    const Pubkey &remote_fund_pubkey,
-    const Amount &input_amount,
-    const Txid &fund_tx_id,
-    const uint32_t fund_vout = 0);
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<TransactionController> &cets,
+    const OracleEventPointTable &point_table,
+    const Privkey &funding_sk,
+    const Script &funding_script_pubkey,
+    const Amount &fund_output_amount,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    uint32_t nb_threads = 1);
 
   /**
-   * @brief
+   * @brief Verify a CET adaptor signature, using a precomputed oracle event
+   * point table in place of the oracle r values.
    *
-   * @param refund_tx the transaction to add the signatures to.
-   * @param fund_lockscript the locking script of the fund transaction.
-   * @param signatures the signatures to add.
-   * @param fund_tx_id the id of the fund transaction.
-   * @param fund_tx_vout the vout of the fund transaction output.
+   * @param adaptor_pair the adaptor signature and its DLEq proof to verify.
+   * @param cet the transaction to verify the signature against.
+   * @param pubkey the public key to verify the signature against.
+   * @param point_table the signature points of the oracle event.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   * @param msgs the hashes of the value representing the event outcome for the
+   * given CET.
+   * @return true if the signature is valid.
+   * @return false otherwise.
    */
-  static void AddSignaturesToRefundTx(
-    TransactionController *refund_tx,
-    const Script &fund_lockscript,
-    const std::vector<ByteData> &signatures,
-    const Txid &fund_tx_id,
-    const uint32_t fund_tx_vout = 0);
+  static bool VerifyCetAdaptorSignature(
+    const AdaptorPair &adaptor_pair,
+    const TransactionController &cet,
+    const Pubkey &pubkey,
+    const OracleEventPointTable &point_table,
+    const Script &funding_script_pubkey,
+    const Amount &fund_output_amount,
+    const std::vector<ByteData256> &msgs);
 
   /**
-   * @brief
+   * @brief Verify a set of CET adaptor signatures, using a precomputed oracle
+   * event point table in place of the oracle r values.
    *
-   * @param refund_tx the transaction to add the signatures to.
-   * @param local_fund_pubkey the fund public key of the local party.
-   * @param remote_fund_pubkey the fund public key of the remote party.
-   * @param signatures the signatures to add.
-   * @param fund_tx_id the id of the fund transaction.
-   * @param fund_tx_vout the vout of the fund transaction output.
+   * @param cets the transactions to verify the signatures against.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param pubkey the public key to verify the signature against.
+   * @param point_table the signature points of the oracle event.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
    */
-  static void AddSignaturesToRefundTx(
-    TransactionController *refund_tx,
-    const Pubkey &local_fund_pubkey,
-    const Pubkey &remote_fund_pubkey,
-    const std::vector<ByteData> &signatures,
-    const Txid &fund_tx_id,
-    const uint32_t fund_tx_vout);
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<TransactionController> &cets,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const Pubkey &pubkey,
+    const OracleEventPointTable &point_table,
+    const Script &funding_script_pubkey,
+    const Amount &fund_output_amount,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
 
   /**
-   * @brief
+   * @brief Create adaptor signatures for a set of CETs given by their
+   * outcomes, the signature hashes being derived from the payouts without
+   * building the CETs.
    *
-   * @param refund_tx the transaction for which to verify the signature.
-   * @param signature the signature to verify.
-   * @param local_fund_pubkey the fund public key of the local party.
-   * @param remote_fund_pubkey the fund public key of the remote party.
-   * @param input_amount the amount locked in the fund transcation output.
-   * @param verify_remote whether to verify the signature using the remote
-   * party public key (if true) or the local party public key (if false).
-   * @param fund_txid the id of the fund transaction.
-   * @param fund_vout the vout of the fund transcation output.
-   * @return true if the signature is valid.
-   * @return false otherwise.
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r value that the oracle will use for the
+   * associated event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
    */
-  static bool VerifyRefundTxSignature(
-    const TransactionController &refund_tx,
-    const ByteData &signature,
-    const Pubkey &local_fund_pubkey,
-    const Pubkey &remote_fund_pubkey,
-    const Amount &input_amount,
-    bool verify_remote,
-    const Txid &fund_txid,
-    uint32_t fund_vout = 0);
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &funding_sk,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    uint32_t nb_threads = 1);
 
   /**
-   * @brief
+   * @brief Create adaptor signatures for a set of CETs given by their
+   * outcomes, the oracle messages being read from a contiguous buffer (see
+   * CetMessageBuffer::FromOutcomes and FromDigitPrefixes).
    *
-   * @param refund_tx the transaction for which to verify the signature.
-   * @param signature the signature to verify.
-   * @param pubkey the public key to verify the signature against.
-   * @param lock_script the locking script of the fund transaction.
-   * @param input_amount the amount locked in the fund transcation output.
-   * @param fund_txid the id of the fund transaction.
-   * @param fund_vout the vout of the fund transcation output.
-   * @return true if the signature is valid.
-   * @return false otherwise.
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r value that the oracle will use for the
+   * associated event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
    */
-  static bool VerifyRefundTxSignature(
-    const TransactionController &refund_tx,
-    const ByteData &signature,
-    const Pubkey &pubkey,
-    const Script &lock_script,
-    const Amount &input_amount,
-    const Txid &fund_txid,
-    uint32_t fund_vout = 0);
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &funding_sk,
+    const CetMessageBuffer &msgs,
+    uint32_t nb_threads = 1);
 
   /**
-   * @brief Get the Raw Funding Transaction Input Signature object
+   * @brief Create adaptor signatures for a set of CETs given by their
+   * outcomes using an oracle nonce context, e.g. one built once for all the
+   * chunks of a stream of CETs.
    *
-   * @param funding_transaction the transaction for which to get a signature
-   * for.
-   * @param privkey the private key to sign with.
-   * @param prev_tx_id the id of the transaction being spent.
-   * @param prev_tx_vout the vout of the output being spent.
-   * @param value the value being spent.
-   * @return ByteData the produced signature.
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param nonce_context the nonce context of the oracle event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
    */
-  static ByteData GetRawFundingTransactionInputSignature(
-    const TransactionController &funding_transaction,
-    const Privkey &privkey,
-    const Txid &prev_tx_id,
-    uint32_t prev_tx_vout,
-    const Amount &value);
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const OracleNonceContext &nonce_context,
+    const Privkey &funding_sk,
+    const CetMessageBuffer &msgs,
+    uint32_t nb_threads = 1);
 
   /**
-   * @brief Create a set of DLC transactions based on the given parameters.
-   * Note that proper fee should be computed ahead of using this function.
+   * @brief Create adaptor signatures for a set of CETs given by their
+   * outcomes, from adaptor points computed beforehand. The adaptor points
+   * only depend on the oracle event, so they can be computed (see
+   * ComputeAdaptorPoints) as soon as the event is known, leaving only the
+   * payout dependent work for when the offer is accepted.
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param adaptor_points the adaptor point of each CET.
+   * @param funding_sk the private key to generate the signature with.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
+   */
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<Pubkey> &adaptor_points,
+    const Privkey &funding_sk,
+    uint32_t nb_threads = 1);
+
+  /**
+   * @brief Verify a set of CET adaptor signatures for CETs given by their
+   * outcomes, the signature hashes being derived from the payouts without
+   * building the CETs.
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param pubkey the public key to verify the signature against.
+   * @param oracle_pubkey the public key of the oracle used for the associated
+   * event.
+   * @param oracle_r_values the r values that the oracle will use to sign the
+   * outcome of the associated event.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const Pubkey &pubkey,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Verify a set of CET adaptor signatures for CETs given by their
+   * outcomes, the oracle messages being read from a contiguous buffer.
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param pubkey the public key to verify the signature against.
+   * @param oracle_pubkey the public key of the oracle used for the associated
+   * event.
+   * @param oracle_r_values the r values that the oracle will use to sign the
+   * outcome of the associated event.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const CetMessageBuffer &msgs,
+    const Pubkey &pubkey,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Create the nonce context used to verify the adaptor signatures of
+   * nb_cets CETs. Every input of a verification is public, so once there are
+   * enough CETs to amortize its construction, the oracle pubkey is multiplied
+   * with a variable time OraclePubkeyTable instead of the constant time
+   * multiplication of libsecp256k1. The context must not be used to sign.
+   *
+   * @param oracle_pubkey the public key of the oracle used for the associated
+   * event.
+   * @param oracle_r_values the r values that the oracle will use to sign the
+   * outcome of the associated event.
+   * @param nb_cets the number of CETs whose signatures will be verified.
+   * @return OracleNonceContext the nonce context.
+   */
+  static OracleNonceContext CreateVerificationNonceContext(
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    size_t nb_cets);
+
+  /**
+   * @brief Verify a CET adaptor signature using an oracle nonce context. As
+   * the inputs of a verification are all public, the context can multiply
+   * the oracle pubkey with a shared variable time OraclePubkeyTable.
+   *
+   * @param adaptor_pair the adaptor signature and its DLEq proof to verify.
+   * @param cet the transaction to verify the signature against.
+   * @param pubkey the public key to verify the signature against.
+   * @param nonce_context the nonce context of the oracle event.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param total_collateral the value of the fund output.
+   * @param msgs the hashes of the value representing the event outcome for the
+   * given CET.
+   * @return true if the signature is valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignature(
+    const AdaptorPair &adaptor_pair,
+    const TransactionController &cet,
+    const Pubkey &pubkey,
+    const OracleNonceContext &nonce_context,
+    const Script &funding_script_pubkey,
+    const Amount &total_collateral,
+    const std::vector<ByteData256> &msgs);
+
+  /**
+   * @brief Verify the adaptor signatures of a set of CETs given by their
+   * outcomes using an oracle nonce context (see VerifyCetAdaptorSignature).
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param pubkey the public key to verify the signature against.
+   * @param nonce_context the nonce context of the oracle event.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const CetMessageBuffer &msgs,
+    const Pubkey &pubkey,
+    const OracleNonceContext &nonce_context,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Verify the adaptor signatures of the CETs [begin, begin +
+   * signature_and_proofs.size()) of a contract using an oracle nonce context,
+   * e.g. the next chunk of a stream of signatures, without copying the
+   * outcomes and messages of the chunk.
+   *
+   * @param outcomes the payouts of all the CETs of the contract.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify, the first one being the one of the CET begin.
+   * @param begin the index of the CET of the first signature.
+   * @param msgs the hash of the events outcome for all the CETs.
+   * @param pubkey the public key to verify the signature against.
+   * @param nonce_context the nonce context of the oracle event.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index (in outcomes) of
+   * the first invalid signature, or to the end of the range if all signatures
+   * are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    size_t begin,
+    const CetMessageBuffer &msgs,
+    const Pubkey &pubkey,
+    const OracleNonceContext &nonce_context,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Verify the adaptor signatures of a set of CETs given by their
+   * outcomes, from adaptor points computed beforehand (see
+   * CreateCetAdaptorSignatures).
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param adaptor_points the adaptor point of each CET.
+   * @param pubkey the public key to verify the signature against.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const std::vector<Pubkey> &adaptor_points,
+    const Pubkey &pubkey,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Create adaptor signatures for a set of CETs given by their
+   * outcomes with the oracle event and local funding key of a crypto
+   * context.
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param context the crypto context of the contract.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
+   */
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const CetMessageBuffer &msgs,
+    const DlcCryptoContext &context,
+    uint32_t nb_threads = 1);
+
+  /**
+   * @brief Verify the adaptor signatures of the remote party for a set of
+   * CETs given by their outcomes, with the oracle event and remote funding
+   * key of a crypto context.
+   *
+   * @param outcomes the payouts of the CETs.
+   * @param sig_hasher the signature hasher of the CETs of the contract.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param context the crypto context of the contract.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<DlcOutcome> &outcomes,
+    const CetSignatureHasher &sig_hasher,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const CetMessageBuffer &msgs,
+    const DlcCryptoContext &context,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Create an Adaptor Signature for a given cet over the fund output
+   * of a contract context.
+   *
+   * @param cet the CET to generate the signature for.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r values that the oracle will use for the
+   * associated event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param contract the contract context.
+   * @param msgs the set of messages for the outcome corresponding to the given
+   * CET.
+   * @return AdaptorPair an adaptor signature and its dleq proof.
+   */
+  static AdaptorPair CreateCetAdaptorSignature(
+    const TransactionController &cet,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &funding_sk,
+    const DlcContractContext &contract,
+    const std::vector<ByteData256> &msgs);
+
+  /**
+   * @brief Create adaptor signatures for a set of CETs over the fund output
+   * of a contract context.
+   *
+   * @param cets the cets to generate adaptor signatures for.
+   * @param oracle_pubkey the pubkey of the oracle for the associated event.
+   * @param oracle_r_values the set of r value that the oracle will use for the
+   * associated event.
+   * @param funding_sk the private key to generate the signature with.
+   * @param contract the contract context.
+   * @param msgs the messages for the outcomes corresponding to the given CETs.
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @return std::vector<AdaptorPair> a set of signature together with their
+   * DLEq proofs.
+   */
+  static std::vector<AdaptorPair> CreateCetAdaptorSignatures(
+    const std::vector<TransactionController> &cets,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const Privkey &funding_sk,
+    const DlcContractContext &contract,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    uint32_t nb_threads = 1);
+
+  /**
+   * @brief Verify a CET adaptor signature over the fund output of a contract
+   * context.
+   *
+   * @param adaptor_pair the adaptor signature and its DLEq proof to verify.
+   * @param cet the transaction to verify the signature against.
+   * @param oracle_pubkey the public key of the oracle used for the associated
+   * event.
+   * @param oracle_r_values the r_values that the oracle will used to create
+   * signatures over the outcome of the associated event.
+   * @param contract the contract context.
+   * @param verify_remote whether to verify the signature using the remote
+   * party public key (if true) or the local party public key (if false).
+   * @param msgs the hashes of the value representing the event outcome for the
+   * given CET.
+   * @return true if the signature is valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignature(
+    const AdaptorPair &adaptor_pair,
+    const TransactionController &cet,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const DlcContractContext &contract,
+    bool verify_remote,
+    const std::vector<ByteData256> &msgs);
+
+  /**
+   * @brief Verify a set of CET adaptor signatures over the fund output of a
+   * contract context.
+   *
+   * @param cets the transactions to verify the signatures against.
+   * @param signature_and_proofs the adaptor signatures and their proofs to
+   * verify.
+   * @param msgs the hash of the events outcome for the given CETs.
+   * @param oracle_pubkey the public key of the oracle used for the associated
+   * event.
+   * @param oracle_r_values the r values that the oracle will use to sign the
+   * outcome of the associated event.
+   * @param contract the contract context.
+   * @param verify_remote whether to verify the signatures using the remote
+   * party public key (if true) or the local party public key (if false).
+   * @param nb_threads the number of worker threads to use (0 to use the
+   * number of hardware threads).
+   * @param invalid_index (out, optional) set to the index of the first invalid
+   * signature, or to the number of CETs if all signatures are valid.
+   * @return true if all signatures are valid.
+   * @return false otherwise.
+   */
+  static bool VerifyCetAdaptorSignatures(
+    const std::vector<TransactionController> &cets,
+    const std::vector<AdaptorPair> &signature_and_proofs,
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const SchnorrPubkey &oracle_pubkey,
+    const std::vector<SchnorrPubkey> &oracle_r_values,
+    const DlcContractContext &contract,
+    bool verify_remote,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr);
+
+  /**
+   * @brief Sign a CET transaction (see SignCet) spending the fund output of a
+   * contract context, without extracting the pubkeys of the multisig script.
+   *
+   * @param cet the CET to which the signatures will be added.
+   * @param adaptor_sig the adaptor signature of the counterparty.
+   * @param oracle_signatures the set of signatures from the oracle over the
+   * corresponding event outcome.
+   * @param funding_sk the private key of the local party.
+   * @param contract the contract context.
+   */
+  static void SignCet(
+    TransactionController *cet,
+    const AdaptorSignature &adaptor_sig,
+    const std::vector<SchnorrSignature> &oracle_signatures,
+    const Privkey &funding_sk,
+    const DlcContractContext &contract);
+
+  /**
+   * @brief Get the signature of a refund transaction spending the fund output
+   * of a contract context.
+   *
+   * @param refund_tx transaction for which to produce a signature.
+   * @param privkey the private key to produce the signature.
+   * @param contract the contract context.
+   * @return ByteData the produced raw signature.
+   */
+  static ByteData GetRawRefundTxSignature(
+    const TransactionController &refund_tx,
+    const Privkey &privkey,
+    const DlcContractContext &contract);
+
+  /**
+   * @brief Add the signatures of both parties to a refund transaction
+   * spending the fund output of a contract context, in the order of the
+   * multisig script.
+   *
+   * @param refund_tx the transaction to add the signatures to.
+   * @param contract the contract context.
+   * @param local_signature the signature of the local party.
+   * @param remote_signature the signature of the remote party.
+   */
+  static void AddSignaturesToRefundTx(
+    TransactionController *refund_tx,
+    const DlcContractContext &contract,
+    const ByteData &local_signature,
+    const ByteData &remote_signature);
+
+  /**
+   * @brief Verify the signature of a refund transaction spending the fund
+   * output of a contract context.
+   *
+   * @param refund_tx the transaction for which to verify the signature.
+   * @param signature the signature to verify.
+   * @param contract the contract context.
+   * @param verify_remote whether to verify the signature using the remote
+   * party public key (if true) or the local party public key (if false).
+   * @return true if the signature is valid.
+   * @return false otherwise.
+   */
+  static bool VerifyRefundTxSignature(
+    const TransactionController &refund_tx,
+    const ByteData &signature,
+    const DlcContractContext &contract,
+    bool verify_remote);
+
+  /**
+   * @brief Get the Raw Refund Tx Signature object
+   *
+   * @param refund_tx transaction for which to produce a signature.
+   * @param privkey the private key to produce the signature.
+   * @param fund_lockscript the locking script of the fund transaction
+   * output.
+   * @param input_amount the amount locked in the fund transaction output.
+   * @param fund_tx_id the id of the fund transaction.
+   * @param fund_vout the vout of the fund transaction output (defaults to
+   * 0).
+   * @return ByteData the produced raw signature.
+   */
+  static ByteData GetRawRefundTxSignature(
+    const TransactionController &refund_tx,
+    const Privkey &privkey,
+    const Script &fund_lockscript,
+    const Amount &input_amount,
+    const Txid &fund_tx_id,
+    const uint32_t fund_vout = 0);
+
+  /**
+   * @brief Get the Raw Refund Tx Signature object
+   *
+   * @param refund_tx transaction for which to produce a signature.
+   * @param privkey the private key to produce the signature.
+   * @param local_fund_pubkey the fund public key of local party.
+   * @param remote_fund_pubkey the fund public key of remote party.
+   * @param input_amount the amount locked in the fund transaction output.
+   * @param fund_tx_id the id of the fund transaction.
+   * @param fund_vout the vout of the fund transaction output (defaults to
+   * 0).
+   * @return ByteData the produced raw signature.
+   */
+  static ByteData GetRawRefundTxSignature(
+    const TransactionController &refund_tx,
+    const Privkey &privkey,
+    const Pubkey &local_fund_pubkey,
+    const Pubkey &remote_fund_pubkey,
+    const Amount &input_amount,
+    const Txid &fund_tx_id,
+    const uint32_t fund_vout = 0);
+
+  /**
+   * @brief
+   *
+   * @param refund_tx the transaction to add the signatures to.
+   * @param fund_lockscript the locking script of the fund transaction.
+   * @param signatures the signatures to add.
+   * @param fund_tx_id the id of the fund transaction.
+   * @param fund_tx_vout the vout of the fund transaction output.
+   */
+  static void AddSignaturesToRefundTx(
+    TransactionController *refund_tx,
+    const Script &fund_lockscript,
+    const std::vector<ByteData> &signatures,
+    const Txid &fund_tx_id,
+    const uint32_t fund_tx_vout = 0);
+
+  /**
+   * @brief
+   *
+   * @param refund_tx the transaction to add the signatures to.
+   * @param local_fund_pubkey the fund public key of the local party.
+   * @param remote_fund_pubkey the fund public key of the remote party.
+   * @param signatures the signatures to add.
+   * @param fund_tx_id the id of the fund transaction.
+   * @param fund_tx_vout the vout of the fund transaction output.
+   */
+  static void AddSignaturesToRefundTx(
+    TransactionController *refund_tx,
+    const Pubkey &local_fund_pubkey,
+    const Pubkey &remote_fund_pubkey,
+    const std::vector<ByteData> &signatures,
+    const Txid &fund_tx_id,
+    const uint32_t fund_tx_vout);
+
+  /**
+   * @brief
+   *
+   * @param refund_tx the transaction for which to verify the signature.
+   * @param signature the signature to verify.
+   * @param local_fund_pubkey the fund public key of the local party.
+   * @param remote_fund_pubkey the fund public key of the remote party.
+   * @param input_amount the amount locked in the fund transcation output.
+   * @param verify_remote whether to verify the signature using the remote
+   * party public key (if true) or the local party public key (if false).
+   * @param fund_txid the id of the fund transaction.
+   * @param fund_vout the vout of the fund transcation output.
+   * @return true if the signature is valid.
+   * @return false otherwise.
+   */
+  static bool VerifyRefundTxSignature(
+    const TransactionController &refund_tx,
+    const ByteData &signature,
+    const Pubkey &local_fund_pubkey,
+    const Pubkey &remote_fund_pubkey,
+    const Amount &input_amount,
+    bool verify_remote,
+    const Txid &fund_txid,
+    uint32_t fund_vout = 0);
+
+  /**
+   * @brief
+   *
+   * @param refund_tx the transaction for which to verify the signature.
+   * @param signature the signature to verify.
+   * @param pubkey the public key to verify the signature against.
+   * @param lock_script the locking script of the fund transaction.
+   * @param input_amount the amount locked in the fund transcation output.
+   * @param fund_txid the id of the fund transaction.
+   * @param fund_vout the vout of the fund transcation output.
+   * @return true if the signature is valid.
+   * @return false otherwise.
+   */
+  static bool VerifyRefundTxSignature(
+    const TransactionController &refund_tx,
+    const ByteData &signature,
+    const Pubkey &pubkey,
+    const Script &lock_script,
+    const Amount &input_amount,
+    const Txid &fund_txid,
+    uint32_t fund_vout = 0);
+
+  /**
+   * @brief Get the Raw Funding Transaction Input Signature object
+   *
+   * @param funding_transaction the transaction for which to get a signature
+   * for.
+   * @param privkey the private key to sign with.
+   * @param prev_tx_id the id of the transaction being spent.
+   * @param prev_tx_vout the vout of the output being spent.
+   * @param value the value being spent.
+   * @return ByteData the produced signature.
+   */
+  static ByteData GetRawFundingTransactionInputSignature(
+    const TransactionController &funding_transaction,
+    const Privkey &privkey,
+    const Txid &prev_tx_id,
+    uint32_t prev_tx_vout,
+    const Amount &value);
+
+  /**
+   * @brief Create a set of DLC transactions based on the given parameters.
+   * Note that proper fee should be computed ahead of using this function.
    *
    * @param outcomes the possible outcome values.
    * @param local_params the parameters for the local party.
@@ -689,6 +1384,41 @@ class CFD_DLC_EXPORT DlcManager {
     const uint64_t cet_lock_time = 0,
     const uint64_t fund_output_serial_id = 0);
 
+  /**
+   * @brief Create a set of DLC transactions based on the given parameters,
+   * passing the CETs one at a time to a handler instead of storing them.
+   * The cets of the returned struct are left empty.
+   *
+   * @param outcomes the possible outcome values.
+   * @param local_params the parameters for the local party.
+   * @param remote_params the parameters for the remote party.
+   * @param refund_locktime the unix time or block number after which the
+   * refund transaction can be used.
+   * @param fee_rate the fee rate to compute the fees.
+   * @param cet_handler the handler called with each CET, in outcome order.
+   * @param option_dest (optional) destination address for the payment of the
+   * option premium
+   * @param option_premium (optional) value for the option premium
+   * @param fund_lock_time the lock time to use for the fund transaction
+   * (optional)
+   * @param cet_lock_time the lock time to use for the cet transactions
+   * (optional)
+   * @return DlcTransactions a struct containing the fund and refund
+   * transactions.
+   */
+  static DlcTransactions CreateDlcTransactions(
+    const std::vector<DlcOutcome> &outcomes,
+    const PartyParams &local_params,
+    const PartyParams &remote_params,
+    uint64_t refund_locktime,
+    uint32_t fee_rate,
+    const CetHandler &cet_handler,
+    const Address &option_dest = Address(),
+    const Amount &option_premium = Amount::CreateBySatoshiAmount(0),
+    const uint64_t fund_lock_time = 0,
+    const uint64_t cet_lock_time = 0,
+    const uint64_t fund_output_serial_id = 0);
+
   /**
    * @brief Create a set of DLC transactions based on the given parameters.
    * Note that proper fee should be computed ahead of using this function.
@@ -720,7 +1450,129 @@ class CFD_DLC_EXPORT DlcManager {
     const std::vector<uint64_t> &fund_output_serial_ids =
       std::vector<uint64_t>());
 
+  /**
+   * @brief Computes an adaptor point from a set of messages, r_values and a
+   * public key. As all signature points share the same public key P, their
+   * sum is computed as sum(R_i) + (sum e_i) * P, so that a single scalar
+   * multiplication is required whatever the number of messages.
+   *
+   * @param msgs the messages to use to compute the signature points.
+   * @param r_values the r_values to use to compute the signature points.
+   * @param pubkey the public key to use to compute the signature points.
+   * @return Pubkey the adaptor point corresponding to the sum of the computed
+   * signature points.
+   */
+  static Pubkey ComputeAdaptorPoint(
+    const std::vector<ByteData256> &msgs,
+    const std::vector<SchnorrPubkey> &r_values,
+    const SchnorrPubkey &pubkey);
+
+  /**
+   * @brief Computes the adaptor points of a set of CETs. The CETs are
+   * visited depth first along the tree of their message prefixes, keeping
+   * the partial sums of signature points of the current path, so that CETs
+   * sharing a prefix (e.g. digit decomposed numeric outcomes) cost about one
+   * point addition each. When the CETs hardly share any message, each point is
+   * computed with ComputeAdaptorPoint instead.
+   *
+   * @param msgs the messages for the outcomes of each CET.
+   * @param r_values the r_values to use to compute the signature points.
+   * @param pubkey the public key to use to compute the signature points.
+   * @return std::vector<Pubkey> the adaptor point of each CET.
+   */
+  static std::vector<Pubkey> ComputeAdaptorPoints(
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const std::vector<SchnorrPubkey> &r_values,
+    const SchnorrPubkey &pubkey);
+
+  /**
+   * @brief Computes the adaptor points of a set of CETs from an oracle nonce
+   * context, visiting the CETs depth first along the tree of their message
+   * prefixes.
+   *
+   * @param msgs the messages for the outcomes of each CET.
+   * @param nonce_context the precomputed challenge midstates and points of
+   * the oracle event.
+   * @return std::vector<Pubkey> the adaptor point of each CET.
+   */
+  static std::vector<Pubkey> ComputeAdaptorPoints(
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const OracleNonceContext &nonce_context);
+
+  /**
+   * @brief Computes the adaptor points of a set of CETs whose messages are
+   * held in a contiguous buffer, from an oracle nonce context.
+   *
+   * @param msgs the messages for the outcomes of each CET.
+   * @param nonce_context the precomputed challenge midstates and points of
+   * the oracle event.
+   * @return std::vector<Pubkey> the adaptor point of each CET.
+   */
+  static std::vector<Pubkey> ComputeAdaptorPoints(
+    const CetMessageBuffer &msgs, const OracleNonceContext &nonce_context);
+
+  /**
+   * @brief Computes the adaptor points of a set of CETs from a precomputed
+   * oracle event point table, visiting the CETs depth first along the tree of
+   * their message prefixes.
+   *
+   * @param msgs the messages for the outcomes of each CET.
+   * @param point_table the signature points of the oracle event.
+   * @return std::vector<Pubkey> the adaptor point of each CET.
+   */
+  static std::vector<Pubkey> ComputeAdaptorPoints(
+    const std::vector<std::vector<ByteData256>> &msgs,
+    const OracleEventPointTable &point_table);
+
  private:
+  /**
+   * @brief Sign a CET transaction (see SignCet) given the position of the
+   * public key of the funding private key in the multisig script.
+   *
+   * @param cet the CET to which the signatures will be added.
+   * @param adaptor_sig the adaptor signature of the counterparty.
+   * @param oracle_signatures the set of signatures from the oracle over the
+   * corresponding event outcome.
+   * @param funding_sk the private key to generate own signature with.
+   * @param is_own_first whether the own signature comes first.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_tx_id the transaction id of the fund transactions.
+   * @param fund_vout the vout of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   */
+  static void SignCet(
+    TransactionController *cet,
+    const AdaptorSignature &adaptor_sig,
+    const std::vector<SchnorrSignature> &oracle_signatures,
+    const Privkey &funding_sk,
+    bool is_own_first,
+    const Script &funding_script_pubkey,
+    const Txid &fund_tx_id,
+    uint32_t fund_vout,
+    const Amount &fund_output_amount);
+
+  /**
+   * @brief Get the raw signature of a funding transaction input (see
+   * GetRawFundingTransactionInputSignature) given the public key of the
+   * private key.
+   *
+   * @param funding_transaction the transaction for which to get a signature
+   * for.
+   * @param privkey the private key to sign with.
+   * @param pubkey the public key of the private key.
+   * @param prev_tx_id the id of the transaction being spent.
+   * @param prev_tx_vout the vout of the output being spent.
+   * @param value the value being spent.
+   * @return ByteData the produced signature.
+   */
+  static ByteData GetRawFundingTransactionInputSignature(
+    const TransactionController &funding_transaction,
+    const Privkey &privkey,
+    const Pubkey &pubkey,
+    const Txid &prev_tx_id,
+    uint32_t prev_tx_vout,
+    const Amount &value);
+
   /**
    * @brief Create a Fund Transaction object
    *
@@ -849,21 +1701,201 @@ class CFD_DLC_EXPORT DlcManager {
    */
   static std::tuple<TxOut, uint64_t, uint64_t> GetBatchChangeOutputAndFees(
     const BatchPartyParams &params, uint64_t fee_rate);
+};
 
+/**
+ * @brief Serialization template of the CETs of a contract. All the CETs of a
+ * contract share their version, input, lock time and output scripts, and only
+ * differ by their two payouts and by the removal of dust outputs. The
+ * template serializes the shared bytes once for each possible set of
+ * outputs, so that a CET is obtained by copying the bytes of its layout and
+ * writing its payouts in place. The serialized CETs are identical to the ones
+ * of DlcManager::CreateCet.
+ *
+ */
+class CFD_DLC_EXPORT CetTemplate {
+ public:
   /**
-   * @brief Computes an adaptor point from a set of messages, r_values and a
-   * public key.
+   * @brief Construct a new Cet Template object.
    *
-   * @param msgs the messages to use to compute the signature points.
-   * @param r_values the r_values to use to compute the signature points.
-   * @param pubkey the public key to use to compute the signature points.
-   * @return Pubkey the adaptor point corresponding to the sum of the computed
-   * signature points.
+   * @param fund_tx_id the tx id of the funding transaction
+   * @param fund_vout the vout of the fund output
+   * @param local_final_script_pubkey the script for the local payout output.
+   * @param remote_final_script_pubkey the script for the remote payout output.
+   * @param lock_time lock time (optional)
+   * @param local_serial_id the serial id of the local payout output.
+   * @param remote_serial_id the serial id of the remote payout output.
    */
-  static Pubkey ComputeAdaptorPoint(
-    const std::vector<ByteData256> &msgs,
-    const std::vector<SchnorrPubkey> &r_values,
-    const SchnorrPubkey &pubkey);
+  CetTemplate(
+    const Txid &fund_tx_id,
+    uint32_t fund_vout,
+    const Script &local_final_script_pubkey,
+    const Script &remote_final_script_pubkey,
+    uint32_t lock_time = 0,
+    uint64_t local_serial_id = 0,
+    uint64_t remote_serial_id = 0);
+
+  /**
+   * @brief Serialize the CET of an outcome.
+   *
+   * @param outcome the payouts of the CET.
+   * @param cet (out) the serialized CET, its capacity being reused.
+   */
+  void SerializeCet(const DlcOutcome &outcome, std::vector<uint8_t> *cet) const;
+
+  /**
+   * @brief Serialize the CET of an outcome.
+   *
+   * @param outcome the payouts of the CET.
+   * @return ByteData the serialized CET.
+   */
+  ByteData SerializeCet(const DlcOutcome &outcome) const;
+
+  /**
+   * @brief Serialize the outputs of the CET of an outcome, without their
+   * count, as hashed in the BIP143 signature hash preimage.
+   *
+   * @param outcome the payouts of the CET.
+   * @param outputs (out) the serialized outputs, its capacity being reused.
+   */
+  void SerializeOutputs(
+    const DlcOutcome &outcome, std::vector<uint8_t> *outputs) const;
+
+  /**
+   * @brief Create the CET of an outcome.
+   *
+   * @param outcome the payouts of the CET.
+   * @return TransactionController the CET.
+   */
+  TransactionController CreateCet(const DlcOutcome &outcome) const;
+
+ private:
+  /**
+   * @brief The serialized CET and the offsets of its payouts for one set of
+   * outputs.
+   */
+  struct Layout {
+    /**
+     * @brief The serialized CET, with null payouts.
+     */
+    std::vector<uint8_t> bytes;
+    /**
+     * @brief The offset of the local payout, or 0 if there is no local output.
+     */
+    size_t local_offset;
+    /**
+     * @brief The offset of the remote payout, or 0 if there is no remote
+     * output.
+     */
+    size_t remote_offset;
+  };
+
+  /**
+   * @brief Get the layout of the CET of an outcome.
+   *
+   * @param outcome the payouts of the CET.
+   * @return const Layout& the layout.
+   */
+  const Layout &GetLayout(const DlcOutcome &outcome) const;
+
+  /**
+   * @brief The layouts of the CETs, indexed by whether the local output (bit
+   * 0) and the remote output (bit 1) are dust.
+   */
+  Layout layouts_[4];
+};
+
+/**
+ * @brief Computes the BIP143 signature hashes of the fund input of the CETs of
+ * a contract. The parts of the preimage shared by all CETs (version, hash of
+ * the prevouts and sequences, outpoint, script code, amount, sequence and
+ * lock time) are serialized once, so that the hash of a CET only requires
+ * hashing its outputs and the preimage, without building a transaction.
+ *
+ */
+class CFD_DLC_EXPORT CetSignatureHasher {
+ public:
+  /**
+   * @brief Buffers reused by the batches of signature hashes computed by a
+   * worker, so that only the hash of the outputs is written in each preimage
+   * after the first batch.
+   */
+  struct Buffers {
+    /**
+     * @brief The id of the hasher that filled the preimages (0 if none).
+     */
+    uint64_t hasher_id = 0;
+    /**
+     * @brief The serialized outputs of each CET of the batch.
+     */
+    std::vector<std::vector<uint8_t>> outputs;
+    /**
+     * @brief The signature hash preimage of each CET of the batch.
+     */
+    std::vector<std::vector<uint8_t>> preimages;
+  };
+
+  /**
+   * @brief Construct a new Cet Signature Hasher object.
+   *
+   * @param cet_template the template of the CETs.
+   * @param funding_script_pubkey the script pubkey of the fund output.
+   * @param fund_output_amount the value of the fund output.
+   */
+  CetSignatureHasher(
+    const CetTemplate &cet_template,
+    const Script &funding_script_pubkey,
+    const Amount &fund_output_amount);
+
+  /**
+   * @brief Get the signature hash (SIGHASH_ALL) of the CET of an outcome.
+   *
+   * @param outcome the payouts of the CET.
+   * @return ByteData256 the signature hash.
+   */
+  ByteData256 GetSignatureHash(const DlcOutcome &outcome) const;
+
+  /**
+   * @brief Get the signature hashes of the CETs of several outcomes, hashing
+   * them together (see BatchHashUtil).
+   *
+   * @param outcomes the payouts of the CETs.
+   * @return std::vector<ByteData256> the signature hash of each CET.
+   */
+  std::vector<ByteData256> GetSignatureHashes(
+    const std::vector<DlcOutcome> &outcomes) const;
+
+  /**
+   * @brief Get the signature hashes of the CETs of a range of outcomes,
+   * hashing them together (see BatchHashUtil) in buffers reused between
+   * calls.
+   *
+   * @param outcomes the payouts of the first CET.
+   * @param nb_outcomes the number of CETs.
+   * @param buffers the buffers of the calling worker.
+   * @return std::vector<ByteData256> the signature hash of each CET.
+   */
+  std::vector<ByteData256> GetSignatureHashes(
+    const DlcOutcome *outcomes, size_t nb_outcomes, Buffers *buffers) const;
+
+ private:
+  /**
+   * @brief The template of the CETs.
+   */
+  CetTemplate cet_template_;
+  /**
+   * @brief The signature hash preimage, with a null hash of the outputs.
+   */
+  std::vector<uint8_t> preimage_;
+  /**
+   * @brief The offset of the hash of the outputs in the preimage.
+   */
+  size_t hash_outputs_offset_;
+  /**
+   * @brief The id of the preimage, unique to each constructed hasher (and
+   * shared by its copies), identifying the preimages kept in Buffers.
+   */
+  uint64_t id_;
 };
 
 }  // namespace dlc
@@ -1 +1,12 @@
-cp ../ecmult_static_context.h ../external/libwally-core/src/secp256k1/sr/
\ No newline at end of file
+#!/bin/bash
+set -e
+# Install the static secp256k1 signing table into the libsecp256k1 sources,
+# so that it is not built at runtime.
+PROJECT_ROOT=$(cd "$(dirname "$0")"/.. && pwd)
+SECP256K1_SRC_DIR=${1:-$PROJECT_ROOT/external/libwally-core/src/secp256k1/src}
+
+# the committed signing table uses ECMULT_GEN_PREC_BITS=4, the table of
+# another precision is generated by the ecmult_static_context target.
+STATIC_CONTEXT=${ECMULT_STATIC_CONTEXT:-$PROJECT_ROOT/ecmult_static_context.h}
+
+cp "$STATIC_CONTEXT" "$SECP256K1_SRC_DIR/ecmult_static_context.h"
@@ -0,0 +1,168 @@
+#!/usr/bin/env python
+"""Generate the static secp256k1 signing table (ecmult_static_context.h), so
+that it is not built when the secp256k1 context is created.
+
+  gen_ecmult_static.py [ECMULT_GEN_PREC_BITS] [OUTPUT]
+    comb table of G used by signing (ECMULT_GEN_PREC_BITS is 2, 4 or 8 and
+    defaults to 4, OUTPUT defaults to ecmult_static_context.h).
+"""
+from __future__ import print_function
+
+import sys
+
+P = 2**256 - 2**32 - 977
+GX = 0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798
+GY = 0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8
+# "The scalar for this x is unknown", the x coordinate of the point with no
+# known discrete logarithm blinding the signing table.
+NUMS_X = 0x546865207363616C617220666F722074686973207820697320756E6B6E6F776E
+
+
+def inverse(value):
+    return pow(value, P - 2, P)
+
+
+def to_jacobian(point):
+    return (point[0], point[1], 1)
+
+
+def double(point):
+    x, y, z = point
+    if z == 0 or y == 0:
+        return (0, 1, 0)
+    yy = y * y % P
+    s = 4 * x * yy % P
+    m = 3 * x * x % P
+    x3 = (m * m - 2 * s) % P
+    y3 = (m * (s - x3) - 8 * yy * yy) % P
+    return (x3, y3, 2 * y * z % P)
+
+
+def add(point1, point2):
+    x1, y1, z1 = point1
+    x2, y2, z2 = point2
+    if z1 == 0:
+        return point2
+    if z2 == 0:
+        return point1
+    z1z1 = z1 * z1 % P
+    z2z2 = z2 * z2 % P
+    u1 = x1 * z2z2 % P
+    u2 = x2 * z1z1 % P
+    s1 = y1 * z2 * z2z2 % P
+    s2 = y2 * z1 * z1z1 % P
+    if u1 == u2:
+        if s1 == s2:
+            return double(point1)
+        return (0, 1, 0)
+    h = (u2 - u1) % P
+    r = (s2 - s1) % P
+    hh = h * h % P
+    hhh = h * hh % P
+    v = u1 * hh % P
+    x3 = (r * r - hhh - 2 * v) % P
+    y3 = (r * (v - x3) - s1 * hhh) % P
+    return (x3, y3, z1 * z2 * h % P)
+
+
+def to_affine(points):
+    """Convert Jacobian points to affine ones with a single inversion."""
+    products = []
+    acc = 1
+    for point in points:
+        acc = acc * point[2] % P
+        products.append(acc)
+    inv = inverse(acc)
+    affine = [None] * len(points)
+    for i in range(len(points) - 1, -1, -1):
+        z_inv = inv * products[i - 1] % P if i > 0 else inv
+        inv = inv * points[i][2] % P
+        zz = z_inv * z_inv % P
+        affine[i] = (points[i][0] * zz % P, points[i][1] * zz * z_inv % P)
+    return affine
+
+
+def storage(point):
+    """Format a point as SECP256K1_GE_STORAGE_CONST arguments."""
+    words = []
+    for coord in point:
+        words += [(coord >> (32 * (7 - i))) & 0xffffffff for i in range(8)]
+    return 'SC(' + ', '.join('%du' % word for word in words) + ')'
+
+
+def lift_x(x):
+    """Return the point with the given x coordinate and an even y."""
+    y = pow((x * x * x + 7) % P, (P + 1) // 4, P)
+    if (y * y - x * x * x - 7) % P != 0:
+        raise ValueError('x is not on the curve.')
+    return (x, y if y % 2 == 0 else P - y)
+
+
+def gen_context(bits, out):
+    """Follow secp256k1_ecmult_gen_context_build: row j holds
+    nums_j + i * (2^bits)^j * G for every digit i, where the nums_j sum to
+    zero so that they cancel out in a multiplication."""
+    prec_n = 256 // bits
+    prec_g = 1 << bits
+    g = to_jacobian((GX, GY))
+    nums = add(to_jacobian(lift_x(NUMS_X)), g)
+    base = g
+    nums_base = nums
+    rows = []
+    for j in range(prec_n):
+        row = [nums_base]
+        for _ in range(1, prec_g):
+            row.append(add(row[-1], base))
+        rows.append(row)
+        for _ in range(bits):
+            base = double(base)
+        nums_base = double(nums_base)
+        if j == prec_n - 2:
+            # the last row uses (1 - 2^j) * nums instead.
+            x, y, z = nums_base
+            nums_base = add((x, P - y, z), nums)
+    points = to_affine([point for row in rows for point in row])
+
+    out.write('#ifndef _SECP256K1_ECMULT_STATIC_CONTEXT_\n')
+    out.write('#define _SECP256K1_ECMULT_STATIC_CONTEXT_\n')
+    out.write('#include "src/group.h"\n')
+    out.write('#define SC SECP256K1_GE_STORAGE_CONST\n')
+    out.write(
+        '#if ECMULT_GEN_PREC_N != %d || ECMULT_GEN_PREC_G != %d\n' %
+        (prec_n, prec_g))
+    out.write(
+        '   #error configuration mismatch, invalid ECMULT_GEN_PREC_N, '
+        'ECMULT_GEN_PREC_G. Try deleting ecmult_static_context.h before the '
+        'build.\n')
+    out.write('#endif\n')
+    out.write(
+        'static const secp256k1_ge_storage secp256k1_ecmult_static_context'
+        '[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G] = {\n')
+    rows_text = []
+    for j in range(prec_n):
+        row = points[j * prec_g:(j + 1) * prec_g]
+        rows_text.append(
+            '{\n' + ',\n'.join('    ' + storage(point) for point in row) +
+            '\n}')
+    out.write(',\n'.join(rows_text))
+    out.write('\n};\n')
+    out.write('#undef SC\n')
+    out.write('#endif\n')
+
+
+def main(argv):
+    if len(argv) > 3:
+        print(__doc__, file=sys.stderr)
+        return 1
+    bits = int(argv[1]) if len(argv) > 1 else 4
+    if bits not in (2, 4, 8):
+        print('ECMULT_GEN_PREC_BITS must be 2, 4 or 8.', file=sys.stderr)
+        return 1
+    output = argv[2] if len(argv) > 2 else 'ecmult_static_context.h'
+    with open(output, 'w') as out:
+        gen_context(bits, out)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,23 @@
+#!/bin/bash
+set -e
+# Compare the CreateCetAdaptorSignatures throughput for each precision of the
+# secp256k1 signing table. Usage: run_ecmult_bench.sh [nb_cets] [nb_nonces]
+# (the libsecp256k1 src directory can be set with SECP256K1_SRC_DIR).
+PROJECT_ROOT=$(cd "$(dirname "$0")"/.. && pwd)
+NB_CETS=${1:-1000}
+NB_NONCES=${2:-1}
+
+# restore the committed signing table, even when a build or a run fails.
+trap '"$PROJECT_ROOT/scripts/ecmult.sh" $SECP256K1_SRC_DIR' EXIT
+
+for BITS in 2 4 8; do
+  BUILD_DIR=$PROJECT_ROOT/build_bench_$BITS
+  cmake -DCMAKE_BUILD_TYPE=Release -DENABLE_TESTS=OFF -DENABLE_BENCH=ON \
+    -DECMULT_GEN_PREC_BITS=$BITS -S "$PROJECT_ROOT" -B "$BUILD_DIR"
+  cmake --build "$BUILD_DIR" --target ecmult_static_context
+  ECMULT_STATIC_CONTEXT=$BUILD_DIR/ecmult_static_context.h \
+    "$PROJECT_ROOT/scripts/ecmult.sh" $SECP256K1_SRC_DIR
+  cmake --build "$BUILD_DIR" --target cfddlc_bench -- -j 4
+  "$BUILD_DIR/Release/cfddlc_bench" "$NB_CETS" "$NB_NONCES" \
+    | grep -E "^nb_cets|CreateCetAdaptorSignatures"
+done
@@ -0,0 +1,148 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_context.h"
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_script.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_transactions.h"
+#include "wally_core.h"  // NOLINT
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+using cfd::core::RandomNumberUtil;
+using cfd::core::ScriptUtil;
+
+void DlcCryptoContext::InitializeSecpContext() {
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    auto seed = RandomNumberUtil::GetRandomBytes(WALLY_SECP_RANDOMIZE_LEN);
+    if (wally_secp_randomize(seed.data(), seed.size()) != WALLY_OK) {
+      throw CfdException(
+        CfdError::kCfdInternalError, "Failed to randomize secp256k1 context.");
+    }
+  });
+}
+
+DlcCryptoContext::DlcCryptoContext(
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &local_fund_privkey,
+  const Pubkey &remote_fund_pubkey)
+    : DlcCryptoContext(
+        std::make_shared<const OraclePubkeyTable>(oracle_pubkey),
+        oracle_r_values, local_fund_privkey, remote_fund_pubkey) {}
+
+DlcCryptoContext::DlcCryptoContext(
+  const std::shared_ptr<const OraclePubkeyTable> &pubkey_table,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &local_fund_privkey,
+  const Pubkey &remote_fund_pubkey)
+    : nonce_context_(pubkey_table, oracle_r_values),
+      local_fund_privkey_(local_fund_privkey),
+      local_fund_pubkey_(local_fund_privkey.GetPubkey()),
+      remote_fund_pubkey_(remote_fund_pubkey),
+      is_local_first_(
+        local_fund_pubkey_.GetHex() < remote_fund_pubkey_.GetHex()) {}
+
+const OracleNonceContext &DlcCryptoContext::GetNonceContext() const {
+  return nonce_context_;
+}
+
+const Privkey &DlcCryptoContext::GetLocalFundPrivkey() const {
+  return local_fund_privkey_;
+}
+
+const Pubkey &DlcCryptoContext::GetLocalFundPubkey() const {
+  return local_fund_pubkey_;
+}
+
+const Pubkey &DlcCryptoContext::GetRemoteFundPubkey() const {
+  return remote_fund_pubkey_;
+}
+
+bool DlcCryptoContext::IsLocalPubkeyFirst() const {
+  return is_local_first_;
+}
+
+DlcContractContext::DlcContractContext(
+  const Pubkey &local_fund_pubkey,
+  const Pubkey &remote_fund_pubkey,
+  const Txid &fund_tx_id,
+  uint32_t fund_vout,
+  const Amount &fund_amount)
+    : local_fund_pubkey_(local_fund_pubkey),
+      remote_fund_pubkey_(remote_fund_pubkey),
+      fund_lockscript_(DlcManager::CreateFundTxLockingScript(
+        local_fund_pubkey, remote_fund_pubkey)),
+      fund_script_pubkey_(
+        ScriptUtil::CreateP2wshLockingScript(fund_lockscript_)),
+      is_local_first_(
+        local_fund_pubkey.GetHex() < remote_fund_pubkey.GetHex()),
+      fund_tx_id_(fund_tx_id),
+      fund_vout_(fund_vout),
+      fund_amount_(fund_amount) {}
+
+DlcContractContext::DlcContractContext(
+  const Pubkey &local_fund_pubkey,
+  const Pubkey &remote_fund_pubkey,
+  const TransactionController &fund_tx)
+    : DlcContractContext(
+        local_fund_pubkey, remote_fund_pubkey,
+        fund_tx.GetTransaction().GetTxid(), 0, Amount()) {
+  const auto &tx = fund_tx.GetTransaction();
+  auto script_hex = fund_script_pubkey_.GetHex();
+  for (uint32_t i = 0; i < tx.GetTxOutCount(); i++) {
+    auto txout = tx.GetTxOut(i);
+    if (txout.GetLockingScript().GetHex() == script_hex) {
+      fund_vout_ = i;
+      fund_amount_ = txout.GetValue();
+      return;
+    }
+  }
+  throw CfdException(
+    CfdError::kCfdIllegalArgumentError,
+    "Fund output not found in the fund transaction.");
+}
+
+const Pubkey &DlcContractContext::GetLocalFundPubkey() const {
+  return local_fund_pubkey_;
+}
+
+const Pubkey &DlcContractContext::GetRemoteFundPubkey() const {
+  return remote_fund_pubkey_;
+}
+
+const Script &DlcContractContext::GetFundLockingScript() const {
+  return fund_lockscript_;
+}
+
+const Script &DlcContractContext::GetFundScriptPubkey() const {
+  return fund_script_pubkey_;
+}
+
+bool DlcContractContext::IsLocalPubkeyFirst() const {
+  return is_local_first_;
+}
+
+const Txid &DlcContractContext::GetFundTxId() const {
+  return fund_tx_id_;
+}
+
+uint32_t DlcContractContext::GetFundVout() const {
+  return fund_vout_;
+}
+
+const Amount &DlcContractContext::GetFundAmount() const {
+  return fund_amount_;
+}
+
+}  // namespace dlc
+}  // namespace cfd
@@ -0,0 +1,247 @@
+// Copyright 2020 CryptoGarage
+
+#ifndef CFD_DLC_SRC_CFDDLC_FIELD_H_
+#define CFD_DLC_SRC_CFDDLC_FIELD_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The portable multiplication can be forced with CFDDLC_NO_INT128 (the
+// ENABLE_INT128 CMake option), e.g. to test the path used by MSVC.
+#if defined(__SIZEOF_INT128__) && !defined(CFDDLC_NO_INT128)
+#define CFDDLC_HAVE_INT128
+#endif
+
+namespace cfd {
+namespace dlc {
+
+/**
+ * @brief A field element, as little endian 64 bit limbs.
+ */
+using FieldElement = std::array<uint64_t, 4>;
+
+/**
+ * @brief The field prime p = 2^256 - 2^32 - 977.
+ */
+static const FieldElement kFieldPrime = {
+  0xfffffffefffffc2fULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL,
+  0xffffffffffffffffULL};
+
+/**
+ * @brief 2^256 mod p, used to fold the high half of a product.
+ */
+static const uint64_t kFieldFold = 0x1000003d1ULL;
+
+/**
+ * @brief Compute a * b + c + carry with 32 bit multiplications, returning the
+ * low 64 bits and setting carry to the high 64 bits (which cannot overflow).
+ */
+inline uint64_t MulAddPortable(
+  uint64_t a, uint64_t b, uint64_t c, uint64_t *carry) {
+  uint64_t a_lo = a & 0xffffffffULL;
+  uint64_t a_hi = a >> 32;
+  uint64_t b_lo = b & 0xffffffffULL;
+  uint64_t b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffULL) + a_lo * b_hi;
+  uint64_t hi = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+  uint64_t lo = (cross << 32) | (lo_lo & 0xffffffffULL);
+  lo += c;
+  hi += (lo < c) ? 1 : 0;
+  lo += *carry;
+  hi += (lo < *carry) ? 1 : 0;
+  *carry = hi;
+  return lo;
+}
+
+/**
+ * @brief Compute a * b + c + carry, returning the low 64 bits and setting
+ * carry to the high 64 bits (which cannot overflow).
+ */
+inline uint64_t MulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t *carry) {
+#ifdef CFDDLC_HAVE_INT128
+  unsigned __int128 value =
+    static_cast<unsigned __int128>(a) * b + c + *carry;
+  *carry = static_cast<uint64_t>(value >> 64);
+  return static_cast<uint64_t>(value);
+#else
+  return MulAddPortable(a, b, c, carry);
+#endif
+}
+
+/**
+ * @brief Compute a + b + carry, setting carry to the carry out.
+ */
+inline uint64_t AddCarry(uint64_t a, uint64_t b, uint64_t *carry) {
+  uint64_t sum = a + *carry;
+  uint64_t carry_out = (sum < *carry) ? 1 : 0;
+  sum += b;
+  carry_out |= (sum < b) ? 1 : 0;
+  *carry = carry_out;
+  return sum;
+}
+
+/**
+ * @brief Compute a - b - borrow, setting borrow to the borrow out.
+ */
+inline uint64_t SubBorrow(uint64_t a, uint64_t b, uint64_t *borrow) {
+  uint64_t diff = a - b;
+  uint64_t borrow_out = (a < b) ? 1 : 0;
+  borrow_out |= (diff < *borrow) ? 1 : 0;
+  diff -= *borrow;
+  *borrow = borrow_out;
+  return diff;
+}
+
+/**
+ * @brief Subtract p from a value (any 256 bit value, as it is lower than 2p)
+ * if it is not lower than p.
+ */
+inline void FieldReduce(FieldElement *value) {
+  auto &r = *value;
+  if (r[3] != kFieldPrime[3] || r[2] != kFieldPrime[2] ||
+      r[1] != kFieldPrime[1] || r[0] < kFieldPrime[0]) {
+    return;
+  }
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = SubBorrow(r[i], kFieldPrime[i], &borrow);
+  }
+}
+
+/**
+ * @brief Add 2^256 mod p to a value that wrapped around 2^256.
+ */
+inline void FieldFold(FieldElement *value) {
+  auto &r = *value;
+  uint64_t carry = 0;
+  r[0] = AddCarry(r[0], kFieldFold, &carry);
+  for (size_t i = 1; i < 4; i++) {
+    r[i] = AddCarry(r[i], 0, &carry);
+  }
+}
+
+/**
+ * @brief Compute a + b mod p, a and b being lower than p.
+ */
+inline FieldElement FieldAdd(const FieldElement &a, const FieldElement &b) {
+  FieldElement r;
+  uint64_t carry = 0;
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = AddCarry(a[i], b[i], &carry);
+  }
+  if (carry != 0) {
+    FieldFold(&r);
+  } else {
+    FieldReduce(&r);
+  }
+  return r;
+}
+
+/**
+ * @brief Compute a - b mod p, a and b being lower than p.
+ */
+inline FieldElement FieldSub(const FieldElement &a, const FieldElement &b) {
+  FieldElement r;
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = SubBorrow(a[i], b[i], &borrow);
+  }
+  if (borrow != 0) {
+    // a - b + 2^256 - (2^256 - p) = a - b + p
+    borrow = 0;
+    r[0] = SubBorrow(r[0], kFieldFold, &borrow);
+    for (size_t i = 1; i < 4; i++) {
+      r[i] = SubBorrow(r[i], 0, &borrow);
+    }
+  }
+  return r;
+}
+
+/**
+ * @brief Compute a * b mod p, reduced below p for any 256 bit a and b.
+ */
+inline FieldElement FieldMul(const FieldElement &a, const FieldElement &b) {
+  uint64_t product[8] = {0};
+  for (size_t i = 0; i < 4; i++) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < 4; j++) {
+      product[i + j] = MulAdd(a[i], b[j], product[i + j], &carry);
+    }
+    product[i + 4] = carry;
+  }
+
+  // high * 2^256 + low = high * (2^256 mod p) + low (mod p), applied twice
+  // as the first folding leaves a 34 bits overflow.
+  FieldElement r;
+  uint64_t carry = 0;
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = MulAdd(product[i + 4], kFieldFold, product[i], &carry);
+  }
+  uint64_t overflow = carry;
+  carry = 0;
+  r[0] = MulAdd(overflow, kFieldFold, r[0], &carry);
+  for (size_t i = 1; i < 4; i++) {
+    r[i] = AddCarry(r[i], 0, &carry);
+  }
+  if (carry != 0) {
+    FieldFold(&r);
+  }
+  FieldReduce(&r);
+  return r;
+}
+
+inline FieldElement FieldSqr(const FieldElement &a) { return FieldMul(a, a); }
+
+/**
+ * @brief Compute the inverse as a^(p - 2).
+ */
+inline FieldElement FieldInv(const FieldElement &a) {
+  FieldElement exponent = kFieldPrime;
+  exponent[0] -= 2;
+  FieldElement r = {{1, 0, 0, 0}};
+  for (int i = 255; i >= 0; i--) {
+    r = FieldSqr(r);
+    if ((exponent[i / 64] >> (i % 64)) & 1) {
+      r = FieldMul(r, a);
+    }
+  }
+  return r;
+}
+
+inline bool FieldIsZero(const FieldElement &a) {
+  return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+/**
+ * @brief Read a field element from 32 big endian bytes.
+ */
+inline FieldElement FieldFromBytes(const uint8_t *bytes) {
+  FieldElement r;
+  for (size_t i = 0; i < 4; i++) {
+    uint64_t limb = 0;
+    for (size_t j = 0; j < 8; j++) {
+      limb = (limb << 8) | bytes[(3 - i) * 8 + j];
+    }
+    r[i] = limb;
+  }
+  return r;
+}
+
+/**
+ * @brief Write a field element as 32 big endian bytes.
+ */
+inline void FieldToBytes(const FieldElement &a, uint8_t *bytes) {
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t j = 0; j < 8; j++) {
+      bytes[(3 - i) * 8 + j] = static_cast<uint8_t>(a[i] >> (56 - j * 8));
+    }
+  }
+}
+
+}  // namespace dlc
+}  // namespace cfd
+
+#endif  // CFD_DLC_SRC_CFDDLC_FIELD_H_
@@ -0,0 +1,403 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <vector>
+
+#include "cfdcore/cfdcore_bytedata.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  (defined(__GNUC__) || defined(__clang__)) && !defined(_MSC_VER)
+#define CFDDLC_SHA256_AVX2
+#include <immintrin.h>
+#endif
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+
+static const uint32_t kSha256RoundConstants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static const uint32_t kSha256InitialState[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+/**
+ * @brief Pad a message to a multiple of the SHA256 block size, its length
+ * being counted from the start of the (already hashed) prefix.
+ */
+static std::vector<uint8_t> PadMessage(
+  const uint8_t *data, size_t size, uint64_t prefix_size = 0) {
+  size_t padded_size = ((size + 8) / 64 + 1) * 64;
+  std::vector<uint8_t> padded(padded_size, 0);
+  if (size != 0) {
+    std::memcpy(padded.data(), data, size);
+  }
+  padded[size] = 0x80;
+  uint64_t bit_size = (prefix_size + size) * 8;
+  for (size_t i = 0; i < 8; i++) {
+    padded[padded_size - 1 - i] = static_cast<uint8_t>(bit_size >> (8 * i));
+  }
+  return padded;
+}
+
+static uint32_t RotateRight(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * @brief Apply the SHA256 compression function to a 64 bytes block.
+ */
+static void Sha256Compress(uint32_t *state, const uint8_t *block) {
+  uint32_t w[64];
+  for (size_t i = 0; i < 16; i++) {
+    const uint8_t *word = block + 4 * i;
+    w[i] = (static_cast<uint32_t>(word[0]) << 24) |
+           (static_cast<uint32_t>(word[1]) << 16) |
+           (static_cast<uint32_t>(word[2]) << 8) |
+           static_cast<uint32_t>(word[3]);
+  }
+  for (size_t i = 16; i < 64; i++) {
+    uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^
+                  (w[i - 15] >> 3);
+    uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^
+                  (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (size_t i = 0; i < 64; i++) {
+    uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + kSha256RoundConstants[i] + w[i];
+    uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + s0 + maj;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+#ifdef CFDDLC_SHA256_AVX2
+
+/**
+ * @brief Number of messages hashed at once, one per 32 bit lane of an AVX2
+ * register.
+ */
+static const size_t kSha256Lanes = 8;
+
+/**
+ * @brief Read a big endian 32 bit word as a signed integer, as expected by
+ * the AVX2 intrinsics.
+ */
+static int ReadWord(const uint8_t *data) {
+  return static_cast<int>(
+    (static_cast<uint32_t>(data[0]) << 24) |
+    (static_cast<uint32_t>(data[1]) << 16) |
+    (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]));
+}
+
+#define CFDDLC_ADD(a, b) _mm256_add_epi32(a, b)
+#define CFDDLC_XOR(a, b) _mm256_xor_si256(a, b)
+#define CFDDLC_ROTR(x, n) \
+  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+/**
+ * @brief Hash eight padded messages of nb_blocks blocks, the state of each
+ * message being kept in its own lane.
+ *
+ * @param lanes the padded messages.
+ * @param nb_blocks the number of blocks of each message.
+ * @param digests (out) the 8 hashes, one after the other.
+ */
+__attribute__((target("avx2"))) static void Sha256Avx2(
+  const uint8_t *const *lanes, size_t nb_blocks, uint8_t *digests) {
+  __m256i state[8];
+  for (size_t i = 0; i < 8; i++) {
+    state[i] = _mm256_set1_epi32(static_cast<int>(kSha256InitialState[i]));
+  }
+
+  __m256i w[64];
+  for (size_t block = 0; block < nb_blocks; block++) {
+    for (size_t t = 0; t < 16; t++) {
+      size_t pos = block * 64 + 4 * t;
+      w[t] = _mm256_set_epi32(
+        ReadWord(lanes[7] + pos), ReadWord(lanes[6] + pos),
+        ReadWord(lanes[5] + pos), ReadWord(lanes[4] + pos),
+        ReadWord(lanes[3] + pos), ReadWord(lanes[2] + pos),
+        ReadWord(lanes[1] + pos), ReadWord(lanes[0] + pos));
+    }
+    for (size_t t = 16; t < 64; t++) {
+      __m256i s0 = CFDDLC_XOR(
+        CFDDLC_XOR(CFDDLC_ROTR(w[t - 15], 7), CFDDLC_ROTR(w[t - 15], 18)),
+        _mm256_srli_epi32(w[t - 15], 3));
+      __m256i s1 = CFDDLC_XOR(
+        CFDDLC_XOR(CFDDLC_ROTR(w[t - 2], 17), CFDDLC_ROTR(w[t - 2], 19)),
+        _mm256_srli_epi32(w[t - 2], 10));
+      w[t] = CFDDLC_ADD(CFDDLC_ADD(w[t - 16], s0), CFDDLC_ADD(w[t - 7], s1));
+    }
+
+    __m256i a = state[0];
+    __m256i b = state[1];
+    __m256i c = state[2];
+    __m256i d = state[3];
+    __m256i e = state[4];
+    __m256i f = state[5];
+    __m256i g = state[6];
+    __m256i h = state[7];
+    for (size_t t = 0; t < 64; t++) {
+      __m256i sum1 = CFDDLC_XOR(
+        CFDDLC_XOR(CFDDLC_ROTR(e, 6), CFDDLC_ROTR(e, 11)), CFDDLC_ROTR(e, 25));
+      __m256i ch = CFDDLC_XOR(
+        _mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+      __m256i temp1 = CFDDLC_ADD(
+        CFDDLC_ADD(h, sum1),
+        CFDDLC_ADD(
+          CFDDLC_ADD(
+            ch,
+            _mm256_set1_epi32(static_cast<int>(kSha256RoundConstants[t]))),
+          w[t]));
+      __m256i sum0 = CFDDLC_XOR(
+        CFDDLC_XOR(CFDDLC_ROTR(a, 2), CFDDLC_ROTR(a, 13)), CFDDLC_ROTR(a, 22));
+      __m256i maj = CFDDLC_XOR(
+        CFDDLC_XOR(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+        _mm256_and_si256(b, c));
+      __m256i temp2 = CFDDLC_ADD(sum0, maj);
+      h = g;
+      g = f;
+      f = e;
+      e = CFDDLC_ADD(d, temp1);
+      d = c;
+      c = b;
+      b = a;
+      a = CFDDLC_ADD(temp1, temp2);
+    }
+    state[0] = CFDDLC_ADD(state[0], a);
+    state[1] = CFDDLC_ADD(state[1], b);
+    state[2] = CFDDLC_ADD(state[2], c);
+    state[3] = CFDDLC_ADD(state[3], d);
+    state[4] = CFDDLC_ADD(state[4], e);
+    state[5] = CFDDLC_ADD(state[5], f);
+    state[6] = CFDDLC_ADD(state[6], g);
+    state[7] = CFDDLC_ADD(state[7], h);
+  }
+
+  uint32_t words[8][kSha256Lanes];
+  for (size_t i = 0; i < 8; i++) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(words[i]), state[i]);
+  }
+  for (size_t lane = 0; lane < kSha256Lanes; lane++) {
+    uint8_t *digest = digests + 32 * lane;
+    for (size_t i = 0; i < 8; i++) {
+      digest[4 * i] = static_cast<uint8_t>(words[i][lane] >> 24);
+      digest[4 * i + 1] = static_cast<uint8_t>(words[i][lane] >> 16);
+      digest[4 * i + 2] = static_cast<uint8_t>(words[i][lane] >> 8);
+      digest[4 * i + 3] = static_cast<uint8_t>(words[i][lane]);
+    }
+  }
+}
+
+#undef CFDDLC_ADD
+#undef CFDDLC_XOR
+#undef CFDDLC_ROTR
+
+/**
+ * @brief Hash the padded messages of the given indexes, which all have
+ * nb_blocks blocks, by groups of eight.
+ */
+static void HashLanes(
+  const std::vector<std::vector<uint8_t>> &padded,
+  const std::vector<size_t> &indexes,
+  size_t nb_blocks,
+  std::vector<uint8_t> *digests) {
+  const uint8_t *lanes[kSha256Lanes];
+  uint8_t lane_digests[kSha256Lanes * 32];
+  for (size_t first = 0; first < indexes.size(); first += kSha256Lanes) {
+    size_t nb_lanes = std::min(kSha256Lanes, indexes.size() - first);
+    for (size_t lane = 0; lane < kSha256Lanes; lane++) {
+      // the unused lanes of the last group hash the first message again.
+      size_t index = indexes[first + (lane < nb_lanes ? lane : 0)];
+      lanes[lane] = padded[index].data();
+    }
+    Sha256Avx2(lanes, nb_blocks, lane_digests);
+    for (size_t lane = 0; lane < nb_lanes; lane++) {
+      std::memcpy(
+        digests->data() + 32 * indexes[first + lane], lane_digests + 32 * lane,
+        32);
+    }
+  }
+}
+
+/**
+ * @brief Hash the messages (twice if is_double is set) with the AVX2
+ * implementation, the digests being concatenated.
+ */
+static std::vector<uint8_t> HashMessages(
+  const std::vector<std::vector<uint8_t>> &messages, bool is_double) {
+  size_t nb = messages.size();
+  std::vector<std::vector<uint8_t>> padded(nb);
+  std::map<size_t, std::vector<size_t>> indexes_by_blocks;
+  for (size_t i = 0; i < nb; i++) {
+    padded[i] = PadMessage(messages[i].data(), messages[i].size());
+    indexes_by_blocks[padded[i].size() / 64].push_back(i);
+  }
+
+  std::vector<uint8_t> digests(nb * 32);
+  for (const auto &group : indexes_by_blocks) {
+    HashLanes(padded, group.second, group.first, &digests);
+  }
+
+  if (is_double) {
+    for (size_t i = 0; i < nb; i++) {
+      padded[i] = PadMessage(digests.data() + 32 * i, 32);
+    }
+    std::vector<size_t> indexes(nb);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    HashLanes(padded, indexes, 1, &digests);
+  }
+  return digests;
+}
+
+/**
+ * @brief Split concatenated digests.
+ */
+static std::vector<ByteData256> SplitDigests(
+  const std::vector<uint8_t> &digests) {
+  std::vector<ByteData256> hashes;
+  hashes.reserve(digests.size() / 32);
+  for (size_t offset = 0; offset < digests.size(); offset += 32) {
+    hashes.push_back(ByteData256(std::vector<uint8_t>(
+      digests.begin() + offset, digests.begin() + offset + 32)));
+  }
+  return hashes;
+}
+
+#endif  // CFDDLC_SHA256_AVX2
+
+std::vector<ByteData256> BatchHashUtil::Sha256(
+  const std::vector<std::vector<uint8_t>> &messages, bool use_simd) {
+#ifdef CFDDLC_SHA256_AVX2
+  if (use_simd && IsSimdAvailable()) {
+    return SplitDigests(HashMessages(messages, false));
+  }
+#endif
+  std::vector<ByteData256> hashes;
+  hashes.reserve(messages.size());
+  for (const auto &message : messages) {
+    hashes.push_back(HashUtil::Sha256(message));
+  }
+  return hashes;
+}
+
+std::vector<ByteData256> BatchHashUtil::Sha256D(
+  const std::vector<std::vector<uint8_t>> &messages, bool use_simd) {
+#ifdef CFDDLC_SHA256_AVX2
+  if (use_simd && IsSimdAvailable()) {
+    return SplitDigests(HashMessages(messages, true));
+  }
+#endif
+  std::vector<ByteData256> hashes;
+  hashes.reserve(messages.size());
+  for (const auto &message : messages) {
+    hashes.push_back(HashUtil::Sha256D(message));
+  }
+  return hashes;
+}
+
+std::vector<uint8_t> BatchHashUtil::Sha256Digests(
+  const std::vector<std::vector<uint8_t>> &messages, bool use_simd) {
+#ifdef CFDDLC_SHA256_AVX2
+  if (use_simd && IsSimdAvailable()) {
+    return HashMessages(messages, false);
+  }
+#endif
+  std::vector<uint8_t> digests;
+  digests.reserve(messages.size() * 32);
+  for (const auto &message : messages) {
+    auto hash = HashUtil::Sha256(message).GetBytes();
+    digests.insert(digests.end(), hash.begin(), hash.end());
+  }
+  return digests;
+}
+
+bool BatchHashUtil::IsSimdAvailable() {
+#ifdef CFDDLC_SHA256_AVX2
+  static const bool is_available = __builtin_cpu_supports("avx2") != 0;
+  return is_available;
+#else
+  return false;
+#endif
+}
+
+Sha256Midstate::Sha256Midstate() : length_(0) {
+  std::memcpy(state_, kSha256InitialState, sizeof(state_));
+}
+
+void Sha256Midstate::Write(const std::vector<uint8_t> &blocks) {
+  if (blocks.size() % 64 != 0) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Midstate data must be a multiple of 64 bytes.");
+  }
+  for (size_t offset = 0; offset < blocks.size(); offset += 64) {
+    Sha256Compress(state_, blocks.data() + offset);
+  }
+  length_ += blocks.size();
+}
+
+ByteData256 Sha256Midstate::Finalize(const std::vector<uint8_t> &data) const {
+  uint32_t state[8];
+  std::memcpy(state, state_, sizeof(state));
+  auto padded = PadMessage(data.data(), data.size(), length_);
+  for (size_t offset = 0; offset < padded.size(); offset += 64) {
+    Sha256Compress(state, padded.data() + offset);
+  }
+
+  std::vector<uint8_t> digest(32);
+  for (size_t i = 0; i < 8; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      digest[4 * i + j] = static_cast<uint8_t>(state[i] >> (24 - 8 * j));
+    }
+  }
+  return ByteData256(digest);
+}
+
+uint64_t Sha256Midstate::GetLength() const { return length_; }
+
+}  // namespace dlc
+}  // namespace cfd
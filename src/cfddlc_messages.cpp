@@ -0,0 +1,148 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_messages.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+#include "cfddlc/cfddlc_hash.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData256;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+
+const size_t CetMessageBuffer::kMessageSize;
+
+CetMessageBuffer::CetMessageBuffer() : offsets_(1, 0) {}
+
+CetMessageBuffer::CetMessageBuffer(
+  const std::vector<std::vector<ByteData256>> &msgs)
+    : CetMessageBuffer() {
+  offsets_.reserve(msgs.size() + 1);
+  for (const auto &cet_msgs : msgs) {
+    for (const auto &msg : cet_msgs) {
+      auto bytes = msg.GetBytes();
+      data_.insert(data_.end(), bytes.begin(), bytes.end());
+    }
+    offsets_.push_back(offsets_.back() + cet_msgs.size());
+  }
+}
+
+CetMessageBuffer CetMessageBuffer::FromOutcomes(
+  const std::vector<std::string> &outcomes, bool use_simd) {
+  std::vector<std::vector<uint8_t>> labels;
+  labels.reserve(outcomes.size());
+  for (const auto &outcome : outcomes) {
+    labels.push_back(std::vector<uint8_t>(outcome.begin(), outcome.end()));
+  }
+
+  CetMessageBuffer buffer;
+  buffer.data_ = BatchHashUtil::Sha256Digests(labels, use_simd);
+  buffer.offsets_.resize(outcomes.size() + 1);
+  for (size_t i = 0; i <= outcomes.size(); i++) {
+    buffer.offsets_[i] = i;
+  }
+  return buffer;
+}
+
+CetMessageBuffer CetMessageBuffer::FromDigitPrefixes(
+  uint32_t base,
+  uint32_t nb_digits,
+  const std::vector<std::vector<uint32_t>> &digit_prefixes,
+  const std::vector<ByteData256> &digit_msgs) {
+  std::vector<uint8_t> digit_data;
+  if (digit_msgs.empty()) {
+    std::vector<std::vector<uint8_t>> digits;
+    digits.reserve(base);
+    for (uint32_t i = 0; i < base; i++) {
+      auto digit = std::to_string(i);
+      digits.push_back(std::vector<uint8_t>(digit.begin(), digit.end()));
+    }
+    digit_data = BatchHashUtil::Sha256Digests(digits);
+  } else {
+    if (digit_msgs.size() < base) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "A message is required for every digit value.");
+    }
+    for (const auto &msg : digit_msgs) {
+      auto bytes = msg.GetBytes();
+      digit_data.insert(digit_data.end(), bytes.begin(), bytes.end());
+    }
+  }
+
+  size_t nb_msgs = 0;
+  for (const auto &prefix : digit_prefixes) {
+    if (prefix.empty() || prefix.size() > nb_digits) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Digit prefix must have between 1 and nb_digits digits.");
+    }
+    for (auto digit : prefix) {
+      if (digit >= base) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError, "Digit value out of the base.");
+      }
+    }
+    nb_msgs += prefix.size();
+  }
+
+  CetMessageBuffer buffer;
+  buffer.data_.resize(nb_msgs * kMessageSize);
+  buffer.offsets_.reserve(digit_prefixes.size() + 1);
+  uint8_t *out = buffer.data_.data();
+  for (const auto &prefix : digit_prefixes) {
+    for (auto digit : prefix) {
+      std::memcpy(out, digit_data.data() + digit * kMessageSize, kMessageSize);
+      out += kMessageSize;
+    }
+    buffer.offsets_.push_back(buffer.offsets_.back() + prefix.size());
+  }
+  return buffer;
+}
+
+void CetMessageBuffer::AddCet(const uint8_t *msgs, size_t nb_msgs) {
+  data_.insert(data_.end(), msgs, msgs + nb_msgs * kMessageSize);
+  offsets_.push_back(offsets_.back() + nb_msgs);
+}
+
+size_t CetMessageBuffer::GetCetCount() const { return offsets_.size() - 1; }
+
+size_t CetMessageBuffer::GetMessageCount(size_t cet_index) const {
+  if (cet_index >= GetCetCount()) {
+    throw CfdException(
+      CfdError::kCfdOutOfRangeError, "CET index out of the message buffer.");
+  }
+  return offsets_[cet_index + 1] - offsets_[cet_index];
+}
+
+const uint8_t *CetMessageBuffer::GetMessage(
+  size_t cet_index, size_t msg_index) const {
+  if (msg_index >= GetMessageCount(cet_index)) {
+    throw CfdException(
+      CfdError::kCfdOutOfRangeError,
+      "Message index out of the messages of the CET.");
+  }
+  return data_.data() + (offsets_[cet_index] + msg_index) * kMessageSize;
+}
+
+std::vector<ByteData256> CetMessageBuffer::GetMessages(
+  size_t cet_index) const {
+  size_t nb_msgs = GetMessageCount(cet_index);
+  std::vector<ByteData256> msgs;
+  msgs.reserve(nb_msgs);
+  for (size_t i = 0; i < nb_msgs; i++) {
+    const uint8_t *msg = GetMessage(cet_index, i);
+    msgs.push_back(
+      ByteData256(std::vector<uint8_t>(msg, msg + kMessageSize)));
+  }
+  return msgs;
+}
+
+}  // namespace dlc
+}  // namespace cfd
@@ -0,0 +1,263 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_numeric.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::Amount;
+using cfd::core::ByteData256;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+
+uint64_t NumericOutcomeManager::GetOutcomeCount(
+  uint32_t base, uint32_t nb_digits) {
+  if (base < 2 || nb_digits == 0) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Base must be at least 2 and number of digits at least 1.");
+  }
+
+  uint64_t count = 1;
+  for (uint32_t i = 0; i < nb_digits; i++) {
+    if (count > UINT64_MAX / base) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Number of outcomes does not fit in 64 bits.");
+    }
+    count *= base;
+  }
+  return count;
+}
+
+std::vector<uint32_t> NumericOutcomeManager::DecomposeOutcome(
+  uint64_t outcome, uint32_t base, uint32_t nb_digits) {
+  std::vector<uint32_t> digits(nb_digits);
+  for (uint32_t i = nb_digits; i > 0; i--) {
+    digits[i - 1] = static_cast<uint32_t>(outcome % base);
+    outcome /= base;
+  }
+  return digits;
+}
+
+std::vector<std::vector<uint32_t>>
+NumericOutcomeManager::ComputeCoveringPrefixes(
+  uint64_t start, uint64_t end, uint32_t base, uint32_t nb_digits) {
+  auto nb_outcomes = GetOutcomeCount(base, nb_digits);
+  if (start > end || end >= nb_outcomes) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Invalid outcome range.");
+  }
+
+  // Greedily take, from the start of the range, the largest aligned block of
+  // base^k outcomes that fits in the range. A block is described by the
+  // nb_digits - k first digits of its first outcome.
+  std::vector<std::vector<uint32_t>> prefixes;
+  uint64_t current = start;
+  while (true) {
+    uint64_t block_size = 1;
+    uint32_t nb_free_digits = 0;
+    while (nb_free_digits + 1 < nb_digits &&
+           current % (block_size * base) == 0 &&
+           end - current >= block_size * base - 1) {
+      block_size *= base;
+      nb_free_digits++;
+    }
+
+    auto digits = DecomposeOutcome(current, base, nb_digits);
+    digits.resize(nb_digits - nb_free_digits);
+    prefixes.push_back(digits);
+
+    if (end - current < block_size) {
+      break;
+    }
+    current += block_size;
+  }
+  return prefixes;
+}
+
+NumericOutcomeCets NumericOutcomeManager::CreateNumericOutcomeCets(
+  const std::vector<PayoutInterval> &intervals,
+  uint32_t base,
+  uint32_t nb_digits,
+  const std::vector<ByteData256> &digit_msgs) {
+  auto nb_outcomes = GetOutcomeCount(base, nb_digits);
+  if (!digit_msgs.empty() && digit_msgs.size() != base) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of digit messages must match the base.");
+  }
+  if (intervals.empty() || intervals.front().start != 0 ||
+      intervals.back().end != nb_outcomes - 1) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Payout intervals must cover all the outcomes.");
+  }
+
+  NumericOutcomeCets cets;
+  for (const auto &interval : MergePayoutIntervals(intervals)) {
+    for (auto &prefix : ComputeCoveringPrefixes(
+           interval.start, interval.end, base, nb_digits)) {
+      cets.outcomes.push_back(interval.payout);
+      cets.digit_prefixes.push_back(std::move(prefix));
+    }
+  }
+
+  cets.msgs = GetPrefixMessages(
+    cets.digit_prefixes,
+    digit_msgs.empty() ? GetDigitMessages(base) : digit_msgs);
+  return cets;
+}
+
+NumericOutcomeCets NumericOutcomeManager::CreateNumericOutcomeCets(
+  const std::vector<PayoutInterval> &intervals,
+  const std::vector<RoundingInterval> &rounding_intervals,
+  uint32_t base,
+  uint32_t nb_digits,
+  int64_t *nb_removed_cets,
+  const std::vector<ByteData256> &digit_msgs) {
+  auto cets = CreateNumericOutcomeCets(
+    RoundPayoutIntervals(intervals, rounding_intervals), base, nb_digits,
+    digit_msgs);
+
+  if (nb_removed_cets != nullptr) {
+    size_t nb_unrounded_cets = 0;
+    for (const auto &interval : MergePayoutIntervals(intervals)) {
+      nb_unrounded_cets +=
+        ComputeCoveringPrefixes(interval.start, interval.end, base, nb_digits)
+          .size();
+    }
+    *nb_removed_cets = static_cast<int64_t>(nb_unrounded_cets) -
+                       static_cast<int64_t>(cets.outcomes.size());
+  }
+  return cets;
+}
+
+std::vector<PayoutInterval> NumericOutcomeManager::RoundPayoutIntervals(
+  const std::vector<PayoutInterval> &intervals,
+  const std::vector<RoundingInterval> &rounding_intervals) {
+  if (rounding_intervals.empty() ||
+      rounding_intervals.front().begin_interval != 0) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Rounding intervals must begin at 0.");
+  }
+  for (size_t i = 0; i < rounding_intervals.size(); i++) {
+    if (rounding_intervals[i].rounding_mod == 0 ||
+        (i > 0 && rounding_intervals[i].begin_interval <=
+                    rounding_intervals[i - 1].begin_interval)) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Rounding intervals must be sorted with a non zero modulus.");
+    }
+  }
+
+  std::vector<PayoutInterval> rounded;
+  rounded.reserve(intervals.size());
+  size_t rounding_index = 0;
+  for (const auto &interval : intervals) {
+    if (interval.start > interval.end) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError, "Invalid payout interval.");
+    }
+    auto total = interval.payout.local_payout + interval.payout.remote_payout;
+    uint64_t start = interval.start;
+    while (true) {
+      while (rounding_index + 1 < rounding_intervals.size() &&
+             rounding_intervals[rounding_index + 1].begin_interval <= start) {
+        rounding_index++;
+      }
+      uint64_t end = interval.end;
+      if (rounding_index + 1 < rounding_intervals.size() &&
+          rounding_intervals[rounding_index + 1].begin_interval <= end) {
+        end = rounding_intervals[rounding_index + 1].begin_interval - 1;
+      }
+
+      auto mod = static_cast<int64_t>(
+        rounding_intervals[rounding_index].rounding_mod);
+      auto local = interval.payout.local_payout.GetSatoshiValue();
+      auto remainder = local % mod;
+      local += (remainder * 2 >= mod) ? mod - remainder : -remainder;
+      local = std::max<int64_t>(
+        0, std::min<int64_t>(local, total.GetSatoshiValue()));
+      auto local_payout = Amount::CreateBySatoshiAmount(local);
+      rounded.push_back({start, end, {local_payout, total - local_payout}});
+
+      if (end == interval.end) {
+        break;
+      }
+      start = end + 1;
+    }
+  }
+
+  return MergePayoutIntervals(rounded);
+}
+
+std::vector<ByteData256> NumericOutcomeManager::GetDigitMessages(
+  uint32_t base) {
+  std::vector<ByteData256> digit_msgs;
+  digit_msgs.reserve(base);
+  for (uint32_t i = 0; i < base; i++) {
+    digit_msgs.push_back(HashUtil::Sha256(std::to_string(i)));
+  }
+  return digit_msgs;
+}
+
+std::vector<std::vector<ByteData256>>
+NumericOutcomeManager::GetPrefixMessages(
+  const std::vector<std::vector<uint32_t>> &digit_prefixes,
+  const std::vector<ByteData256> &digit_msgs) {
+  std::vector<std::vector<ByteData256>> msgs;
+  msgs.reserve(digit_prefixes.size());
+  for (const auto &prefix : digit_prefixes) {
+    std::vector<ByteData256> prefix_msgs;
+    prefix_msgs.reserve(prefix.size());
+    for (auto digit : prefix) {
+      if (digit >= digit_msgs.size()) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError,
+          "Digit value out of the digit messages.");
+      }
+      prefix_msgs.push_back(digit_msgs[digit]);
+    }
+    msgs.push_back(prefix_msgs);
+  }
+  return msgs;
+}
+
+std::vector<PayoutInterval> NumericOutcomeManager::MergePayoutIntervals(
+  const std::vector<PayoutInterval> &intervals) {
+  std::vector<PayoutInterval> merged;
+  for (const auto &interval : intervals) {
+    if (interval.start > interval.end) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError, "Invalid payout interval.");
+    }
+    if (!merged.empty() && interval.start != merged.back().end + 1) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Payout intervals must be sorted and contiguous.");
+    }
+    if (!merged.empty() &&
+        interval.payout.local_payout == merged.back().payout.local_payout &&
+        interval.payout.remote_payout == merged.back().payout.remote_payout) {
+      merged.back().end = interval.end;
+    } else {
+      merged.push_back(interval);
+    }
+  }
+  return merged;
+}
+
+}  // namespace dlc
+}  // namespace cfd
@@ -0,0 +1,396 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_oracle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_key.h"
+#include "cfdcore/cfdcore_schnorrsig.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_point.h"
+#include "secp256k1.h"  // NOLINT
+#include "wally_core.h"  // NOLINT
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData;
+using cfd::core::ByteData256;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+
+/**
+ * @brief Order of the secp256k1 group.
+ */
+static const uint8_t kCurveOrder[32] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xfe, 0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48,
+  0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41};
+
+/**
+ * @brief Reduce a 32 bytes big endian value modulo the curve order. As the
+ * value is lower than twice the order, one subtraction is enough.
+ */
+static void ReduceScalar(std::vector<uint8_t> *scalar) {
+  auto &bytes = *scalar;
+  if (std::lexicographical_compare(
+        bytes.begin(), bytes.end(), kCurveOrder, kCurveOrder + 32)) {
+    return;
+  }
+  int borrow = 0;
+  for (int i = 31; i >= 0; i--) {
+    int value = bytes[i] - kCurveOrder[i] - borrow;
+    borrow = (value < 0) ? 1 : 0;
+    bytes[i] = static_cast<uint8_t>(value + (borrow << 8));
+  }
+}
+
+/**
+ * @brief Get the point with even y coordinate of an x-only public key.
+ */
+static Pubkey LiftXOnlyPubkey(const SchnorrPubkey &pubkey) {
+  std::vector<uint8_t> bytes = {0x02};
+  auto x_bytes = pubkey.GetData().GetBytes();
+  bytes.insert(bytes.end(), x_bytes.begin(), x_bytes.end());
+  return Pubkey(ByteData(bytes));
+}
+
+/**
+ * @brief Number of bits of the scalar covered by each window of an oracle
+ * pubkey table, and the resulting numbers of windows and of non zero digits.
+ */
+static const size_t kTableWindowBits = 4;
+static const size_t kTableWindowCount = 256 / kTableWindowBits;
+static const size_t kTableDigitCount = (1 << kTableWindowBits) - 1;
+
+/**
+ * @brief Parse a public key into the internal representation of libsecp256k1.
+ */
+static secp256k1_pubkey ParsePubkey(const Pubkey &pubkey) {
+  auto bytes = pubkey.GetData().GetBytes();
+  secp256k1_pubkey point;
+  if (secp256k1_ec_pubkey_parse(
+        wally_get_secp_context(), &point, bytes.data(), bytes.size()) != 1) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Invalid public key.");
+  }
+  return point;
+}
+
+/**
+ * @brief Add points in the internal representation of libsecp256k1.
+ */
+static secp256k1_pubkey AddPoints(
+  const secp256k1_pubkey *const *points, size_t nb_points) {
+  secp256k1_pubkey sum;
+  if (nb_points == 0 ||
+      secp256k1_ec_pubkey_combine(
+        wally_get_secp_context(), &sum, points, nb_points) != 1) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "The sum of the points is the point at infinity.");
+  }
+  return sum;
+}
+
+/**
+ * @brief Serialize a point in the internal representation of libsecp256k1.
+ */
+static Pubkey SerializePubkey(const secp256k1_pubkey &point) {
+  std::vector<uint8_t> serialized(Pubkey::kCompressedPubkeySize);
+  size_t size = serialized.size();
+  secp256k1_ec_pubkey_serialize(
+    wally_get_secp_context(), serialized.data(), &size, &point,
+    SECP256K1_EC_COMPRESSED);
+  return Pubkey(ByteData(serialized));
+}
+
+OraclePubkeyTable::OraclePubkeyTable(const SchnorrPubkey &oracle_pubkey)
+    : oracle_pubkey_(oracle_pubkey),
+      points_(
+        kTableWindowCount * kTableDigitCount * sizeof(secp256k1_pubkey)) {
+  // base is 16^window * P, and each row holds its multiples 1 to 15. The
+  // rows are summed in Jacobian coordinates and converted together, to an
+  // encoding that is parsed without computing square roots.
+  std::vector<JacobianPoint> rows;
+  rows.reserve(kTableWindowCount * kTableDigitCount);
+  JacobianPoint base(LiftXOnlyPubkey(oracle_pubkey));
+  for (size_t window = 0; window < kTableWindowCount; window++) {
+    rows.push_back(base);
+    for (size_t digit = 1; digit < kTableDigitCount; digit++) {
+      rows.push_back(rows.back().Add(base));
+    }
+    base = rows.back().Add(base);
+  }
+
+  auto pubkeys = JacobianPoint::ToPubkeys(rows, false);
+  auto *points = reinterpret_cast<secp256k1_pubkey *>(points_.data());
+  for (size_t i = 0; i < pubkeys.size(); i++) {
+    points[i] = ParsePubkey(pubkeys[i]);
+  }
+}
+
+const SchnorrPubkey &OraclePubkeyTable::GetOraclePubkey() const {
+  return oracle_pubkey_;
+}
+
+Pubkey OraclePubkeyTable::Multiply(const ByteData256 &scalar) const {
+  secp256k1_pubkey product;
+  MultiplyPoint(scalar, product.data);
+  return SerializePubkey(product);
+}
+
+void OraclePubkeyTable::MultiplyPoint(
+  const ByteData256 &scalar, uint8_t *point) const {
+  auto bytes = scalar.GetBytes();
+  const auto *points =
+    reinterpret_cast<const secp256k1_pubkey *>(points_.data());
+  const secp256k1_pubkey *terms[kTableWindowCount];
+  size_t nb_terms = 0;
+  for (size_t window = 0; window < kTableWindowCount; window++) {
+    // the windows start from the least significant bits of the scalar.
+    uint8_t byte = bytes[31 - window / 2];
+    size_t digit = (window % 2 == 0) ? (byte & 0x0f) : (byte >> 4);
+    if (digit != 0) {
+      terms[nb_terms++] = &points[window * kTableDigitCount + digit - 1];
+    }
+  }
+
+  auto product = AddPoints(terms, nb_terms);
+  std::memcpy(point, product.data, sizeof(product.data));
+}
+
+OracleNonceContext::OracleNonceContext(
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values)
+    : oracle_pubkey_(oracle_pubkey),
+      oracle_r_values_(oracle_r_values),
+      parsed_points_((oracle_r_values.size() + 1) * sizeof(secp256k1_pubkey)) {
+  // the tag prefix fills the first block and R || P the second one.
+  auto tag_hash =
+    HashUtil::Sha256(std::string("BIP0340/challenge")).GetBytes();
+  std::vector<uint8_t> tag_prefix(tag_hash);
+  tag_prefix.insert(tag_prefix.end(), tag_hash.begin(), tag_hash.end());
+  Sha256Midstate tag_midstate;
+  tag_midstate.Write(tag_prefix);
+
+  auto *points = reinterpret_cast<secp256k1_pubkey *>(parsed_points_.data());
+  points[0] = ParsePubkey(LiftXOnlyPubkey(oracle_pubkey));
+  auto pubkey_bytes = oracle_pubkey.GetData().GetBytes();
+  challenge_midstates_.reserve(oracle_r_values.size());
+  for (size_t i = 0; i < oracle_r_values.size(); i++) {
+    points[i + 1] = ParsePubkey(LiftXOnlyPubkey(oracle_r_values[i]));
+    auto block = oracle_r_values[i].GetData().GetBytes();
+    block.insert(block.end(), pubkey_bytes.begin(), pubkey_bytes.end());
+    challenge_midstates_.push_back(tag_midstate);
+    challenge_midstates_.back().Write(block);
+  }
+}
+
+OracleNonceContext::OracleNonceContext(
+  const std::shared_ptr<const OraclePubkeyTable> &pubkey_table,
+  const std::vector<SchnorrPubkey> &oracle_r_values)
+    : OracleNonceContext(pubkey_table->GetOraclePubkey(), oracle_r_values) {
+  pubkey_table_ = pubkey_table;
+}
+
+const SchnorrPubkey &OracleNonceContext::GetOraclePubkey() const {
+  return oracle_pubkey_;
+}
+
+const std::vector<SchnorrPubkey> &OracleNonceContext::GetOracleRValues()
+  const {
+  return oracle_r_values_;
+}
+
+size_t OracleNonceContext::GetNonceCount() const {
+  return oracle_r_values_.size();
+}
+
+ByteData256 OracleNonceContext::ComputeChallenge(
+  size_t nonce_index, const ByteData256 &msg) const {
+  if (nonce_index >= GetNonceCount()) {
+    throw CfdException(
+      CfdError::kCfdOutOfRangeError, "Nonce index out of the oracle event.");
+  }
+  auto challenge =
+    challenge_midstates_[nonce_index].Finalize(msg.GetBytes()).GetBytes();
+  ReduceScalar(&challenge);
+  return ByteData256(challenge);
+}
+
+Pubkey OracleNonceContext::ComputeSigPoint(
+  size_t nonce_index, const ByteData256 &msg) const {
+  auto challenge = ComputeChallenge(nonce_index, msg);
+  const auto *points =
+    reinterpret_cast<const secp256k1_pubkey *>(parsed_points_.data());
+  secp256k1_pubkey product;
+  MultiplyOraclePoint(challenge, product.data);
+  const secp256k1_pubkey *terms[] = {&points[nonce_index + 1], &product};
+  return SerializePubkey(AddPoints(terms, 2));
+}
+
+Pubkey OracleNonceContext::ComputeAdaptorPoint(
+  const std::vector<ByteData256> &msgs) const {
+  if (msgs.empty()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "No message provided.");
+  }
+  if (msgs.size() > GetNonceCount()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of r values must be greater or equal to number of messages.");
+  }
+
+  // sum(R_i + e_i * P) = sum(R_i) + (sum e_i) * P, which only requires a
+  // single scalar multiplication whatever the number of nonces.
+  const auto *points =
+    reinterpret_cast<const secp256k1_pubkey *>(parsed_points_.data());
+  std::vector<const secp256k1_pubkey *> terms;
+  terms.reserve(msgs.size() + 1);
+  Privkey challenge_sum;
+  for (size_t i = 0; i < msgs.size(); i++) {
+    terms.push_back(&points[i + 1]);
+    auto challenge = ComputeChallenge(i, msgs[i]);
+    challenge_sum = (i == 0) ? Privkey(challenge)
+                             : challenge_sum.CreateTweakAdd(challenge);
+  }
+  secp256k1_pubkey product;
+  MultiplyOraclePoint(
+    ByteData256(challenge_sum.GetData().GetBytes()), product.data);
+  terms.push_back(&product);
+  return SerializePubkey(AddPoints(terms.data(), terms.size()));
+}
+
+void OracleNonceContext::MultiplyOraclePoint(
+  const ByteData256 &scalar, uint8_t *point) const {
+  if (pubkey_table_) {
+    pubkey_table_->MultiplyPoint(scalar, point);
+    return;
+  }
+  std::memcpy(point, parsed_points_.data(), sizeof(secp256k1_pubkey));
+  auto bytes = scalar.GetBytes();
+  if (secp256k1_ec_pubkey_tweak_mul(
+        wally_get_secp_context(), reinterpret_cast<secp256k1_pubkey *>(point),
+        bytes.data()) != 1) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Invalid oracle pubkey scalar.");
+  }
+}
+
+OracleEventPointTable::OracleEventPointTable(
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const std::vector<ByteData256> &digit_msgs)
+    : OracleEventPointTable(
+        OracleNonceContext(oracle_pubkey, oracle_r_values), digit_msgs) {}
+
+OracleEventPointTable::OracleEventPointTable(
+  const OracleNonceContext &nonce_context,
+  const std::vector<ByteData256> &digit_msgs)
+    : oracle_pubkey_(nonce_context.GetOraclePubkey()),
+      oracle_r_values_(nonce_context.GetOracleRValues()) {
+  if (oracle_r_values_.empty() || digit_msgs.empty()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "At least one r value and one message are required.");
+  }
+
+  digit_msgs_.reserve(digit_msgs.size());
+  for (const auto &msg : digit_msgs) {
+    digit_msgs_.push_back(msg.GetBytes());
+  }
+
+  sig_points_.reserve(oracle_r_values_.size() * digit_msgs.size());
+  for (size_t i = 0; i < oracle_r_values_.size(); i++) {
+    for (const auto &msg : digit_msgs) {
+      sig_points_.push_back(nonce_context.ComputeSigPoint(i, msg));
+    }
+  }
+}
+
+const SchnorrPubkey &OracleEventPointTable::GetOraclePubkey() const {
+  return oracle_pubkey_;
+}
+
+const std::vector<SchnorrPubkey> &OracleEventPointTable::GetOracleRValues()
+  const {
+  return oracle_r_values_;
+}
+
+size_t OracleEventPointTable::GetNonceCount() const {
+  return oracle_r_values_.size();
+}
+
+size_t OracleEventPointTable::GetDigitCount() const {
+  return digit_msgs_.size();
+}
+
+size_t OracleEventPointTable::GetDigitIndex(const ByteData256 &msg) const {
+  auto bytes = msg.GetBytes();
+  for (size_t i = 0; i < digit_msgs_.size(); i++) {
+    if (digit_msgs_[i] == bytes) {
+      return i;
+    }
+  }
+
+  throw CfdException(
+    CfdError::kCfdIllegalArgumentError,
+    "Message not part of the oracle event point table.");
+}
+
+const Pubkey &OracleEventPointTable::GetSigPoint(
+  size_t nonce_index, size_t digit_index) const {
+  if (nonce_index >= GetNonceCount() || digit_index >= GetDigitCount()) {
+    throw CfdException(
+      CfdError::kCfdOutOfRangeError,
+      "Nonce or digit index out of the oracle event point table.");
+  }
+  return sig_points_[nonce_index * GetDigitCount() + digit_index];
+}
+
+Pubkey OracleEventPointTable::ComputeAdaptorPoint(
+  const std::vector<ByteData256> &msgs) const {
+  std::vector<size_t> digit_indexes;
+  digit_indexes.reserve(msgs.size());
+  for (const auto &msg : msgs) {
+    digit_indexes.push_back(GetDigitIndex(msg));
+  }
+  return ComputeAdaptorPoint(digit_indexes);
+}
+
+Pubkey OracleEventPointTable::ComputeAdaptorPoint(
+  const std::vector<size_t> &digit_indexes) const {
+  if (digit_indexes.empty()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "No message provided.");
+  }
+  if (digit_indexes.size() > GetNonceCount()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of r values must be greater or equal to number of messages.");
+  }
+
+  if (digit_indexes.size() == 1) {
+    return GetSigPoint(0, digit_indexes[0]);
+  }
+
+  std::vector<Pubkey> points;
+  points.reserve(digit_indexes.size());
+  for (size_t i = 0; i < digit_indexes.size(); i++) {
+    points.push_back(GetSigPoint(i, digit_indexes[i]));
+  }
+  return Pubkey::CombinePubkey(points);
+}
+
+}  // namespace dlc
+}  // namespace cfd
@@ -0,0 +1,216 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_payout_curve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::Amount;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+
+/**
+ * @brief Number of outcomes evaluated at once, small enough for the block
+ * buffers to stay in the L1 cache.
+ */
+static const uint64_t kEvaluationBlockSize = 512;
+
+/**
+ * @brief Evaluate a piece for the nb outcomes starting at first.
+ */
+static void EvaluatePiece(
+  const PayoutCurvePiece &piece, uint64_t first, size_t nb, double *values) {
+  const auto &coefficients = piece.coefficients;
+  if (piece.type == kPayoutHyperbola) {
+    double a = coefficients[0];
+    double b = coefficients[1];
+    double offset = static_cast<double>(first) - coefficients[2];
+    for (size_t j = 0; j < nb; j++) {
+      values[j] = a + b / (offset + static_cast<double>(j));
+    }
+    return;
+  }
+
+  // Horner's scheme, one coefficient at a time over the whole block.
+  double offset = static_cast<double>(first - piece.start);
+  double last = coefficients.back();
+  for (size_t j = 0; j < nb; j++) {
+    values[j] = last;
+  }
+  for (size_t k = coefficients.size() - 1; k > 0; k--) {
+    double coefficient = coefficients[k - 1];
+    for (size_t j = 0; j < nb; j++) {
+      values[j] =
+        values[j] * (offset + static_cast<double>(j)) + coefficient;
+    }
+  }
+}
+
+PayoutCurve::PayoutCurve(const std::vector<PayoutCurvePiece> &pieces)
+    : pieces_(pieces) {
+  if (pieces.empty()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Payout curve has no piece.");
+  }
+
+  for (size_t i = 0; i < pieces.size(); i++) {
+    const auto &piece = pieces[i];
+    if (piece.start > piece.end ||
+        (i > 0 && piece.start != pieces[i - 1].end + 1)) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Payout curve pieces must be sorted and contiguous.");
+    }
+    for (auto coefficient : piece.coefficients) {
+      if (!std::isfinite(coefficient)) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError,
+          "Payout curve coefficients must be finite.");
+      }
+    }
+
+    if (piece.type == kPayoutPolynomial) {
+      if (piece.coefficients.empty()) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError,
+          "Polynomial piece requires at least one coefficient.");
+      }
+    } else if (piece.type == kPayoutHyperbola) {
+      if (piece.coefficients.size() != 3) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError,
+          "Hyperbola piece requires three coefficients.");
+      }
+      double asymptote = piece.coefficients[2];
+      if (asymptote >= static_cast<double>(piece.start) &&
+          asymptote <= static_cast<double>(piece.end)) {
+        throw CfdException(
+          CfdError::kCfdIllegalArgumentError,
+          "Hyperbola piece asymptote within the piece.");
+      }
+    } else {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError, "Unknown payout curve piece.");
+    }
+  }
+}
+
+PayoutCurvePiece PayoutCurve::CreateLinearPiece(
+  uint64_t start, int64_t start_payout, uint64_t end, int64_t end_payout) {
+  double slope = 0;
+  if (end > start) {
+    slope = static_cast<double>(end_payout - start_payout) /
+            static_cast<double>(end - start);
+  }
+  return {
+    kPayoutPolynomial, start, end,
+    {static_cast<double>(start_payout), slope}};
+}
+
+uint64_t PayoutCurve::GetStart() const { return pieces_.front().start; }
+
+uint64_t PayoutCurve::GetEnd() const { return pieces_.back().end; }
+
+void PayoutCurve::ComputeLocalPayouts(
+  uint64_t start,
+  uint64_t end,
+  const Amount &total_collateral,
+  int64_t *local_payouts) const {
+  if (start > end || start < GetStart() || end > GetEnd()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Outcome range out of the payout curve.");
+  }
+
+  double total = static_cast<double>(total_collateral.GetSatoshiValue());
+  double values[kEvaluationBlockSize];
+  auto piece = std::upper_bound(
+    pieces_.begin(), pieces_.end(), start,
+    [](uint64_t outcome, const PayoutCurvePiece &p) {
+      return outcome < p.start;
+    }) - 1;
+
+  uint64_t first = start;
+  while (true) {
+    uint64_t last = std::min(end, piece->end);
+    if (last - first >= kEvaluationBlockSize) {
+      last = first + kEvaluationBlockSize - 1;
+    }
+    auto nb = static_cast<size_t>(last - first + 1);
+
+    EvaluatePiece(*piece, first, nb, values);
+    int64_t *payouts = local_payouts + (first - start);
+    for (size_t j = 0; j < nb; j++) {
+      double value = std::floor(values[j] + 0.5);
+      value = (value < 0) ? 0 : value;
+      value = (value > total) ? total : value;
+      payouts[j] = static_cast<int64_t>(value);
+    }
+
+    if (last == end) {
+      break;
+    }
+    if (last == piece->end) {
+      ++piece;
+    }
+    first = last + 1;
+  }
+}
+
+std::vector<DlcOutcome> PayoutCurve::ComputeOutcomes(
+  const Amount &total_collateral) const {
+  std::vector<DlcOutcome> outcomes;
+  outcomes.reserve(static_cast<size_t>(GetEnd() - GetStart() + 1));
+  int64_t payouts[kEvaluationBlockSize];
+  for (uint64_t first = GetStart();; first += kEvaluationBlockSize) {
+    uint64_t last = (GetEnd() - first < kEvaluationBlockSize)
+                      ? GetEnd()
+                      : first + kEvaluationBlockSize - 1;
+    ComputeLocalPayouts(first, last, total_collateral, payouts);
+    for (uint64_t i = 0; i <= last - first; i++) {
+      auto local_payout = Amount::CreateBySatoshiAmount(payouts[i]);
+      outcomes.push_back({local_payout, total_collateral - local_payout});
+    }
+    if (last == GetEnd()) {
+      break;
+    }
+  }
+  return outcomes;
+}
+
+std::vector<PayoutInterval> PayoutCurve::ComputePayoutIntervals(
+  const Amount &total_collateral) const {
+  std::vector<PayoutInterval> intervals;
+  int64_t payouts[kEvaluationBlockSize];
+  int64_t current_payout = -1;
+  for (uint64_t first = GetStart();; first += kEvaluationBlockSize) {
+    uint64_t last = (GetEnd() - first < kEvaluationBlockSize)
+                      ? GetEnd()
+                      : first + kEvaluationBlockSize - 1;
+    ComputeLocalPayouts(first, last, total_collateral, payouts);
+    for (uint64_t i = 0; i <= last - first; i++) {
+      if (payouts[i] == current_payout) {
+        intervals.back().end = first + i;
+        continue;
+      }
+      current_payout = payouts[i];
+      auto local_payout = Amount::CreateBySatoshiAmount(current_payout);
+      DlcOutcome payout = {local_payout, total_collateral - local_payout};
+      intervals.push_back({first + i, first + i, payout});
+    }
+    if (last == GetEnd()) {
+      break;
+    }
+  }
+  return intervals;
+}
+
+}  // namespace dlc
+}  // namespace cfd
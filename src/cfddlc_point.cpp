@@ -0,0 +1,197 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_point.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "cfdcore/cfdcore_bytedata.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfddlc_field.h"  // NOLINT
+#include "secp256k1.h"  // NOLINT
+#include "wally_core.h"  // NOLINT
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::ByteData;
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+
+static FieldElement Load(const uint64_t *limbs) {
+  return {{limbs[0], limbs[1], limbs[2], limbs[3]}};
+}
+
+static void Store(const FieldElement &a, uint64_t *limbs) {
+  std::memcpy(limbs, a.data(), sizeof(uint64_t) * 4);
+}
+
+JacobianPoint::JacobianPoint()
+    : x_{}, y_{}, z_{}, infinity_(true), affine_(false) {}
+
+JacobianPoint::JacobianPoint(const Pubkey &pubkey)
+    : infinity_(false), affine_(true) {
+  auto bytes = pubkey.GetData().GetBytes();
+  const auto *ctx = wally_get_secp_context();
+  secp256k1_pubkey point;
+  uint8_t uncompressed[65];
+  size_t size = sizeof(uncompressed);
+  if (secp256k1_ec_pubkey_parse(ctx, &point, bytes.data(), bytes.size()) !=
+        1 ||
+      secp256k1_ec_pubkey_serialize(
+        ctx, uncompressed, &size, &point, SECP256K1_EC_UNCOMPRESSED) != 1) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Invalid public key.");
+  }
+  Store(FieldFromBytes(uncompressed + 1), x_);
+  Store(FieldFromBytes(uncompressed + 33), y_);
+  Store({{1, 0, 0, 0}}, z_);
+}
+
+bool JacobianPoint::IsInfinity() const { return infinity_; }
+
+JacobianPoint JacobianPoint::Add(const JacobianPoint &point) const {
+  if (infinity_) {
+    return point;
+  }
+  if (point.infinity_) {
+    return *this;
+  }
+
+  // add-2007-bl, skipping the products by Z when it is 1.
+  auto z1 = Load(z_);
+  auto z2 = Load(point.z_);
+  auto u1 = Load(x_);
+  auto s1 = Load(y_);
+  if (!point.affine_) {
+    auto z2z2 = FieldSqr(z2);
+    u1 = FieldMul(u1, z2z2);
+    s1 = FieldMul(s1, FieldMul(z2, z2z2));
+  }
+  auto u2 = Load(point.x_);
+  auto s2 = Load(point.y_);
+  if (!affine_) {
+    auto z1z1 = FieldSqr(z1);
+    u2 = FieldMul(u2, z1z1);
+    s2 = FieldMul(s2, FieldMul(z1, z1z1));
+  }
+
+  auto h = FieldSub(u2, u1);
+  auto r = FieldSub(s2, s1);
+  if (FieldIsZero(h)) {
+    return FieldIsZero(r) ? Double() : JacobianPoint();
+  }
+
+  auto hh = FieldSqr(h);
+  auto hhh = FieldMul(h, hh);
+  auto v = FieldMul(u1, hh);
+  auto x3 = FieldSub(FieldSub(FieldSqr(r), hhh), FieldAdd(v, v));
+  auto y3 = FieldSub(FieldMul(r, FieldSub(v, x3)), FieldMul(s1, hhh));
+  auto z3 = h;
+  if (!affine_) {
+    z3 = FieldMul(z3, z1);
+  }
+  if (!point.affine_) {
+    z3 = FieldMul(z3, z2);
+  }
+
+  JacobianPoint sum;
+  Store(x3, sum.x_);
+  Store(y3, sum.y_);
+  Store(z3, sum.z_);
+  sum.infinity_ = false;
+  return sum;
+}
+
+JacobianPoint JacobianPoint::Double() const {
+  if (infinity_) {
+    return *this;
+  }
+
+  // dbl-2009-l, as secp256k1 has a = 0 and no point of order 2.
+  auto x = Load(x_);
+  auto y = Load(y_);
+  auto a = FieldSqr(x);
+  auto b = FieldSqr(y);
+  auto c = FieldSqr(b);
+  auto d = FieldSub(FieldSub(FieldSqr(FieldAdd(x, b)), a), c);
+  d = FieldAdd(d, d);
+  auto e = FieldAdd(FieldAdd(a, a), a);
+  auto x3 = FieldSub(FieldSqr(e), FieldAdd(d, d));
+  auto c8 = FieldAdd(c, c);
+  c8 = FieldAdd(c8, c8);
+  c8 = FieldAdd(c8, c8);
+  auto y3 = FieldSub(FieldMul(e, FieldSub(d, x3)), c8);
+  auto z3 = FieldAdd(y, y);
+  if (!affine_) {
+    z3 = FieldMul(z3, Load(z_));
+  }
+
+  JacobianPoint result;
+  Store(x3, result.x_);
+  Store(y3, result.y_);
+  Store(z3, result.z_);
+  result.infinity_ = false;
+  return result;
+}
+
+Pubkey JacobianPoint::ToPubkey() const {
+  return ToPubkeys(std::vector<JacobianPoint>{*this})[0];
+}
+
+std::vector<Pubkey> JacobianPoint::ToPubkeys(
+  const std::vector<JacobianPoint> &points, bool is_compressed) {
+  // prefix products of the Z coordinates, whose single inverse then gives
+  // the inverse of each Z walking backwards.
+  std::vector<size_t> indexes;
+  std::vector<FieldElement> products;
+  for (size_t i = 0; i < points.size(); i++) {
+    if (points[i].infinity_) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "The point at infinity is not a valid public key.");
+    }
+    if (!points[i].affine_) {
+      auto z = Load(points[i].z_);
+      products.push_back(products.empty() ? z : FieldMul(products.back(), z));
+      indexes.push_back(i);
+    }
+  }
+
+  std::vector<FieldElement> z_inverses(indexes.size());
+  if (!indexes.empty()) {
+    auto inverse = FieldInv(products.back());
+    for (size_t k = indexes.size(); k-- > 0;) {
+      z_inverses[k] = (k == 0) ? inverse : FieldMul(inverse, products[k - 1]);
+      inverse = FieldMul(inverse, Load(points[indexes[k]].z_));
+    }
+  }
+
+  std::vector<Pubkey> pubkeys;
+  pubkeys.reserve(points.size());
+  size_t k = 0;
+  for (const auto &point : points) {
+    auto x = Load(point.x_);
+    auto y = Load(point.y_);
+    if (!point.affine_) {
+      auto z_inverse2 = FieldSqr(z_inverses[k]);
+      x = FieldMul(x, z_inverse2);
+      y = FieldMul(y, FieldMul(z_inverse2, z_inverses[k]));
+      k++;
+    }
+    std::vector<uint8_t> bytes(is_compressed ? 33 : 65);
+    if (is_compressed) {
+      bytes[0] = static_cast<uint8_t>(0x02 | (y[0] & 1));
+    } else {
+      bytes[0] = 0x04;
+      FieldToBytes(y, bytes.data() + 33);
+    }
+    FieldToBytes(x, bytes.data() + 1);
+    pubkeys.push_back(Pubkey(ByteData(bytes)));
+  }
+  return pubkeys;
+}
+
+}  // namespace dlc
+}  // namespace cfd
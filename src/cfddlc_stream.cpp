@@ -0,0 +1,136 @@
+// Copyright 2020 CryptoGarage
+
+#include "cfddlc/cfddlc_stream.h"
+
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+
+namespace cfd {
+namespace dlc {
+
+using cfd::core::CfdError;
+using cfd::core::CfdException;
+
+/**
+ * @brief Create the signature hasher of the CETs of a contract.
+ */
+static CetSignatureHasher CreateSignatureHasher(
+  const CetTransactionParams &params) {
+  CetTemplate cet_template(
+    params.fund_tx_id, params.fund_vout, params.local_final_script_pubkey,
+    params.remote_final_script_pubkey, params.lock_time,
+    params.local_serial_id, params.remote_serial_id);
+  return CetSignatureHasher(
+    cet_template, params.funding_script_pubkey, params.fund_output_amount);
+}
+
+StreamingCetSigner::StreamingCetSigner(
+  const CetTransactionParams &params,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &funding_sk,
+  size_t chunk_size,
+  uint32_t nb_threads)
+    : sig_hasher_(CreateSignatureHasher(params)),
+      nonce_context_(oracle_pubkey, oracle_r_values),
+      funding_sk_(funding_sk),
+      chunk_size_(chunk_size),
+      nb_threads_(nb_threads) {
+  if (chunk_size == 0) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "Chunk size must not be 0.");
+  }
+  outcomes_.reserve(chunk_size);
+  msgs_.reserve(chunk_size);
+}
+
+size_t StreamingCetSigner::Sign(
+  const CetOutcomeSource &source, const AdaptorPairSink &sink) {
+  size_t nb_signed = 0;
+  while (true) {
+    outcomes_.clear();
+    msgs_.clear();
+    source(chunk_size_, &outcomes_, &msgs_);
+    if (outcomes_.empty() && msgs_.empty()) {
+      break;
+    }
+    if (outcomes_.size() != msgs_.size() || outcomes_.size() > chunk_size_) {
+      throw CfdException(
+        CfdError::kCfdIllegalArgumentError,
+        "Invalid chunk of outcomes provided by the source.");
+    }
+
+    auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+      outcomes_, sig_hasher_, nonce_context_, funding_sk_,
+      CetMessageBuffer(msgs_), nb_threads_);
+
+    sink(nb_signed, adaptor_pairs);
+    nb_signed += adaptor_pairs.size();
+  }
+
+  return nb_signed;
+}
+
+CetSignatureVerifier::CetSignatureVerifier(
+  const CetTransactionParams &params,
+  const Pubkey &pubkey,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const std::vector<DlcOutcome> &outcomes,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  uint32_t nb_threads)
+    : sig_hasher_(CreateSignatureHasher(params)),
+      pubkey_(pubkey),
+      nonce_context_(DlcManager::CreateVerificationNonceContext(
+        oracle_pubkey, oracle_r_values, outcomes.size())),
+      outcomes_(outcomes),
+      msgs_(msgs),
+      nb_threads_(nb_threads),
+      nb_received_(0),
+      invalid_index_(outcomes.size()) {
+  if (outcomes.size() != msgs.size()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of outcomes differ from number of messages");
+  }
+}
+
+bool CetSignatureVerifier::AddSignatures(
+  const std::vector<AdaptorPair> &adaptor_pairs) {
+  if (adaptor_pairs.size() > outcomes_.size() - nb_received_) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of signatures exceeds the number of cets.");
+  }
+  size_t begin = nb_received_;
+  nb_received_ += adaptor_pairs.size();
+  if (invalid_index_ != outcomes_.size() || adaptor_pairs.empty()) {
+    return invalid_index_ == outcomes_.size();
+  }
+
+  size_t invalid_index = 0;
+  if (!DlcManager::VerifyCetAdaptorSignatures(
+        outcomes_, sig_hasher_, adaptor_pairs, begin, msgs_, pubkey_,
+        nonce_context_, nb_threads_, &invalid_index)) {
+    invalid_index_ = invalid_index;
+    return false;
+  }
+  return true;
+}
+
+size_t CetSignatureVerifier::GetReceivedCount() const { return nb_received_; }
+
+bool CetSignatureVerifier::Finalize(size_t *invalid_index) const {
+  size_t first_invalid = invalid_index_;
+  if (first_invalid == outcomes_.size() && nb_received_ < outcomes_.size()) {
+    first_invalid = nb_received_;
+  }
+  if (invalid_index != nullptr) {
+    *invalid_index = first_invalid;
+  }
+  return first_invalid == outcomes_.size();
+}
+
+}  // namespace dlc
+}  // namespace cfd
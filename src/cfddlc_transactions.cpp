@@ -3,12 +3,23 @@
 #include "cfddlc/cfddlc_transactions.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstring>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <numeric>
 #include <string>
+#include <system_error>  // NOLINT
+#include <thread>  // NOLINT
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "cfd/cfd_transaction.h"
@@ -21,7 +32,10 @@
 #include "cfdcore/cfdcore_script.h"
 #include "cfdcore/cfdcore_transaction.h"
 #include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_hash.h"
+#include "cfddlc/cfddlc_point.h"
 #include "secp256k1.h"  // NOLINT
+#include "wally_core.h"  // NOLINT
 
 namespace cfd {
 namespace dlc {
@@ -43,7 +57,6 @@ using cfd::core::HashUtil;
 using cfd::core::NetType;
 using cfd::core::Privkey;
 using cfd::core::Pubkey;
-using cfd::core::SchnorrUtil;
 using cfd::core::ScriptBuilder;
 using cfd::core::ScriptOperator;
 using cfd::core::ScriptUtil;
@@ -72,6 +85,391 @@ static bool CompareOutputSerialId(TxOutputInfo i1, TxOutputInfo i2) {
   return (i1.output_serial_id < i2.output_serial_id);
 }
 
+static uint32_t GetWorkerCount(uint32_t nb_threads, size_t nb_items) {
+  size_t count = nb_threads;
+  if (count == 0) {
+    count = std::thread::hardware_concurrency();
+  }
+  count = std::min(count, nb_items);
+  return count == 0 ? 1 : static_cast<uint32_t>(count);
+}
+
+/**
+ * @brief Run work(worker_index) on nb_workers threads, the calling thread
+ * being used as the first worker. The first exception thrown by a worker is
+ * rethrown once all workers have finished.
+ */
+static void RunOnWorkers(
+  uint32_t nb_workers, const std::function<void(uint32_t)> &work) {
+  if (nb_workers <= 1) {
+    work(0);
+    return;
+  }
+
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto run_worker = [&work, &error, &error_mutex](uint32_t index) {
+    try {
+      work(index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(nb_workers - 1);
+  for (uint32_t index = 1; index < nb_workers; index++) {
+    try {
+      workers.emplace_back(run_worker, index);
+    } catch (const std::system_error &) {
+      run_worker(index);
+    }
+  }
+  run_worker(0);
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/**
+ * @brief Split [0, nb_items) in contiguous chunks and process each of them on
+ * its own worker thread.
+ */
+static void RunInParallel(
+  size_t nb_items,
+  uint32_t nb_threads,
+  const std::function<void(size_t, size_t)> &work) {
+  auto nb_workers = GetWorkerCount(nb_threads, nb_items);
+  size_t chunk_size = (nb_items + nb_workers - 1) / nb_workers;
+  RunOnWorkers(nb_workers, [&](uint32_t index) {
+    auto begin = std::min(index * chunk_size, nb_items);
+    work(begin, std::min(begin + chunk_size, nb_items));
+  });
+}
+
+/**
+ * @brief Number of CET signature hashes computed together, bounding the
+ * memory used by the batch hashing of a worker.
+ */
+static const size_t kSigHashBatchSize = 256;
+
+/**
+ * @brief Minimum number of oracle pubkey multiplications for which building
+ * an OraclePubkeyTable costs less than multiplying each time.
+ */
+static const size_t kPubkeyTableMinMultiplications = 32;
+
+/**
+ * @brief Make sure the secp256k1 context shared with cfd-core is created on
+ * the calling thread before starting the workers, as its lazy creation is not
+ * thread safe. Randomizing it is left to the startup call of
+ * DlcCryptoContext::InitializeSecpContext, as it must not happen while other
+ * threads use the context.
+ */
+static void CreateSecpContext() {
+  wally_get_secp_context();
+}
+
+static void CheckNonceCount(size_t nb_nonces, size_t nb_msgs) {
+  if (nb_msgs == 0) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError, "No message provided.");
+  }
+  if (nb_nonces < nb_msgs) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of r values must be greater or equal to number of messages.");
+  }
+}
+
+/**
+ * @brief Get the signature hash of the fund input of a CET.
+ */
+static ByteData256 GetCetSignatureHash(
+  const TransactionController &cet,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral) {
+  return cet.GetTransaction().GetSignatureHash(
+    0, funding_script_pubkey.GetData(), SigHashType(), total_collateral,
+    WitnessVersion::kVersion0);
+}
+
+/**
+ * @brief Create the adaptor signature of a CET for a given adaptor point.
+ */
+static AdaptorPair CreateAdaptorSignature(
+  const TransactionController &cet,
+  const Pubkey &adaptor_point,
+  const Privkey &funding_sk,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral) {
+  auto sig_hash =
+    GetCetSignatureHash(cet, funding_script_pubkey, total_collateral);
+  return AdaptorUtil::Sign(sig_hash, funding_sk, adaptor_point);
+}
+
+/**
+ * @brief Verify the adaptor signature of a CET for a given adaptor point.
+ */
+static bool VerifyAdaptorSignature(
+  const AdaptorPair &adaptor_pair,
+  const TransactionController &cet,
+  const Pubkey &pubkey,
+  const Pubkey &adaptor_point,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral) {
+  auto sig_hash =
+    GetCetSignatureHash(cet, funding_script_pubkey, total_collateral);
+  return AdaptorUtil::Verify(
+    adaptor_pair.signature, adaptor_pair.proof, adaptor_point, sig_hash,
+    pubkey);
+}
+
+/**
+ * @brief A message used as a map key without heap allocation.
+ */
+using MessageKey = std::array<uint8_t, CetMessageBuffer::kMessageSize>;
+
+/**
+ * @brief Compute the adaptor points of the CETs [begin, end) by walking the
+ * tree of their message prefixes depth first. The CETs are visited in the
+ * lexicographic order of their messages while a stack keeps the partial sums
+ * of signature points along the current path, so that a CET only costs one
+ * point addition per message it does not share with the previous one. The
+ * signature point of each distinct (nonce, message) pair is obtained once
+ * from get_sig_point. The adaptor point of the CET i is written to
+ * adaptor_points[i - begin].
+ *
+ * @return false (and nothing is computed) if there are more than
+ * max_sig_points distinct (nonce, message) pairs.
+ */
+static bool ComputePrefixAdaptorPoints(
+  const CetMessageBuffer &msgs,
+  size_t begin,
+  size_t end,
+  const std::function<Pubkey(size_t, const ByteData256 &)> &get_sig_point,
+  size_t max_sig_points,
+  Pubkey *adaptor_points) {
+  // messages are interned per nonce so that prefixes compare as integers.
+  std::vector<std::map<MessageKey, uint32_t>> ids;
+  std::vector<std::vector<const uint8_t *>> distinct_msgs;
+  std::vector<std::vector<uint32_t>> keys(end - begin);
+  size_t nb_sig_points = 0;
+  MessageKey msg_key;
+  for (size_t i = begin; i < end; i++) {
+    auto &key = keys[i - begin];
+    size_t nb_msgs = msgs.GetMessageCount(i);
+    key.reserve(nb_msgs);
+    for (size_t depth = 0; depth < nb_msgs; depth++) {
+      if (ids.size() <= depth) {
+        ids.resize(depth + 1);
+        distinct_msgs.resize(depth + 1);
+      }
+      const uint8_t *msg = msgs.GetMessage(i, depth);
+      std::copy(msg, msg + msg_key.size(), msg_key.begin());
+      auto id = static_cast<uint32_t>(distinct_msgs[depth].size());
+      auto inserted = ids[depth].emplace(msg_key, id);
+      if (inserted.second) {
+        if (++nb_sig_points > max_sig_points) {
+          return false;
+        }
+        distinct_msgs[depth].push_back(msg);
+      }
+      key.push_back(inserted.first->second);
+    }
+  }
+
+  std::vector<std::vector<JacobianPoint>> sig_points(distinct_msgs.size());
+  for (size_t depth = 0; depth < distinct_msgs.size(); depth++) {
+    for (const auto *msg : distinct_msgs[depth]) {
+      sig_points[depth].push_back(JacobianPoint(get_sig_point(
+        depth,
+        ByteData256(
+          std::vector<uint8_t>(msg, msg + CetMessageBuffer::kMessageSize)))));
+    }
+  }
+
+  std::vector<size_t> order(end - begin);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+    return keys[a] < keys[b];
+  });
+
+  // the sums stay in Jacobian coordinates and are converted to pubkeys
+  // together, with a single field inversion.
+  std::vector<JacobianPoint> partial_sums;
+  std::vector<JacobianPoint> sums(end - begin);
+  const std::vector<uint32_t> *previous = nullptr;
+  for (auto index : order) {
+    const auto &key = keys[index];
+    size_t common = 0;
+    if (previous != nullptr) {
+      while (common < key.size() && common < previous->size() &&
+             key[common] == (*previous)[common]) {
+        common++;
+      }
+    }
+    partial_sums.erase(partial_sums.begin() + common, partial_sums.end());
+    for (size_t depth = common; depth < key.size(); depth++) {
+      const auto &point = sig_points[depth][key[depth]];
+      partial_sums.push_back(
+        (depth == 0) ? point : partial_sums.back().Add(point));
+    }
+    sums[index] = partial_sums[key.size() - 1];
+    previous = &key;
+  }
+
+  auto pubkeys = JacobianPoint::ToPubkeys(sums);
+  std::copy(pubkeys.begin(), pubkeys.end(), adaptor_points);
+  return true;
+}
+
+/**
+ * @brief Compute the adaptor points of the CETs [begin, end) from the oracle
+ * nonce context, writing the one of the CET i to adaptor_points[i - begin].
+ */
+static void ComputeAdaptorPointsInRange(
+  const CetMessageBuffer &msgs,
+  size_t begin,
+  size_t end,
+  const OracleNonceContext &nonce_context,
+  Pubkey *adaptor_points) {
+  auto get_sig_point = [&](size_t nonce_index, const ByteData256 &msg) {
+    return nonce_context.ComputeSigPoint(nonce_index, msg);
+  };
+  // When CETs hardly share messages (e.g. enumerated outcomes), computing
+  // every distinct signature point costs more than the single scalar
+  // multiplication per CET of ComputeAdaptorPoint.
+  if (ComputePrefixAdaptorPoints(
+        msgs, begin, end, get_sig_point, end - begin, adaptor_points)) {
+    return;
+  }
+  for (size_t i = begin; i < end; i++) {
+    adaptor_points[i - begin] =
+      nonce_context.ComputeAdaptorPoint(msgs.GetMessages(i));
+  }
+}
+
+/**
+ * @brief Compute the adaptor points of the CETs [begin, end) from an oracle
+ * event point table, writing the one of the CET i to
+ * adaptor_points[i - begin].
+ */
+static void ComputeAdaptorPointsInRange(
+  const CetMessageBuffer &msgs,
+  size_t begin,
+  size_t end,
+  const OracleEventPointTable &point_table,
+  Pubkey *adaptor_points) {
+  auto get_sig_point = [&](size_t nonce_index, const ByteData256 &msg) {
+    return point_table.GetSigPoint(
+      nonce_index, point_table.GetDigitIndex(msg));
+  };
+  ComputePrefixAdaptorPoints(
+    msgs, begin, end, get_sig_point, std::numeric_limits<size_t>::max(),
+    adaptor_points);
+}
+
+/**
+ * @brief Maximum number of CETs claimed at once by a verification worker. The
+ * adaptor points (and signature hashes) of a block are computed together
+ * before verifying its signatures, so this bounds the work done by each
+ * worker after an invalid signature is found.
+ */
+static const size_t kVerifyBlockSize = 128;
+
+/**
+ * @brief Run verify_block on blocks of the indexes [0, nb_items) using
+ * nb_threads workers and stop as soon as one of them fails.
+ * verify_block(worker_index, begin, end) returns the first invalid index of
+ * [begin, end), or end if all are valid. The worker index is lower than
+ * GetWorkerCount(nb_threads, nb_items).
+ * invalid_index (if not null) is set to the lowest failing index, or nb_items
+ * if all succeeded.
+ */
+static bool VerifyInParallel(
+  size_t nb_items,
+  uint32_t nb_threads,
+  const std::function<size_t(uint32_t, size_t, size_t)> &verify_block,
+  size_t *invalid_index) {
+  // Blocks are handed out in increasing order rather than in fixed chunks,
+  // so that every worker stops after its current block once the first
+  // invalid signature is found, whatever its position in the list. As
+  // workers only check the flag before claiming a new block, all indexes
+  // lower than an invalid one are fully verified, and the lowest invalid
+  // index found is the first invalid one of the list.
+  auto nb_workers = GetWorkerCount(nb_threads, nb_items);
+  size_t block_size = std::max<size_t>(
+    1, std::min(kVerifyBlockSize, (nb_items + nb_workers - 1) / nb_workers));
+  std::atomic<size_t> next_begin(0);
+  std::atomic<bool> all_valid(true);
+  size_t first_invalid = nb_items;
+  std::mutex invalid_mutex;
+  RunOnWorkers(nb_workers, [&](uint32_t worker_index) {
+    try {
+      while (all_valid.load(std::memory_order_relaxed)) {
+        auto begin = next_begin.fetch_add(block_size);
+        if (begin >= nb_items) {
+          break;
+        }
+        auto end = std::min(begin + block_size, nb_items);
+        auto invalid = verify_block(worker_index, begin, end);
+        if (invalid < end) {
+          std::lock_guard<std::mutex> lock(invalid_mutex);
+          first_invalid = std::min(first_invalid, invalid);
+          all_valid = false;
+        }
+      }
+    } catch (...) {
+      all_valid = false;
+      throw;
+    }
+  });
+
+  if (invalid_index != nullptr) {
+    *invalid_index = first_invalid;
+  }
+  return all_valid;
+}
+
+/**
+ * @brief Verify the adaptor signatures of the CETs [begin, end) of outcomes,
+ * hashing their signature hashes together in the buffers of the worker. The
+ * signature and adaptor point of the CET i are signature_and_proofs[i - begin]
+ * and adaptor_points[i - begin].
+ *
+ * @return the first invalid index of [begin, end), or end if all are valid.
+ */
+static size_t VerifyOutcomeSignaturesInRange(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const AdaptorPair *signature_and_proofs,
+  const Pubkey *adaptor_points,
+  const Pubkey &pubkey,
+  size_t begin,
+  size_t end,
+  CetSignatureHasher::Buffers *buffers) {
+  auto sig_hashes = sig_hasher.GetSignatureHashes(
+    outcomes.data() + begin, end - begin, buffers);
+  for (size_t i = begin; i < end; i++) {
+    const auto &adaptor_pair = signature_and_proofs[i - begin];
+    if (!AdaptorUtil::Verify(
+          adaptor_pair.signature, adaptor_pair.proof,
+          adaptor_points[i - begin], sig_hashes[i - begin], pubkey)) {
+      return i;
+    }
+  }
+  return end;
+}
+
 TransactionController DlcManager::CreateCet(
   const TxOut &local_output,
   const TxOut &remote_output,
@@ -110,14 +508,14 @@ std::vector<TransactionController> DlcManager::CreateCets(
   const uint32_t fund_vout,
   const Script &local_final_script_pubkey,
   const Script &remote_final_script_pubkey,
-  const std::vector<DlcOutcome> outcomes,
+  const std::vector<DlcOutcome> &outcomes,
   uint32_t lock_time,
   uint64_t local_serial_id,
   uint64_t remote_serial_id) {
   std::vector<TransactionController> cets;
   cets.reserve(outcomes.size());
 
-  for (auto outcome : outcomes) {
+  for (const auto &outcome : outcomes) {
     TxOut local_output(outcome.local_payout, local_final_script_pubkey);
     TxOut remote_output(outcome.remote_payout, remote_final_script_pubkey);
     cets.push_back(CreateCet(
@@ -128,6 +526,26 @@ std::vector<TransactionController> DlcManager::CreateCets(
   return cets;
 }
 
+void DlcManager::CreateCets(
+  const Txid &fund_tx_id,
+  const uint32_t fund_vout,
+  const Script &local_final_script_pubkey,
+  const Script &remote_final_script_pubkey,
+  const std::vector<DlcOutcome> &outcomes,
+  const CetHandler &cet_handler,
+  uint32_t lock_time,
+  uint64_t local_serial_id,
+  uint64_t remote_serial_id) {
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    TxOut local_output(outcomes[i].local_payout, local_final_script_pubkey);
+    TxOut remote_output(outcomes[i].remote_payout, remote_final_script_pubkey);
+    cet_handler(
+      i, CreateCet(
+           local_output, remote_output, fund_tx_id, fund_vout, lock_time,
+           local_serial_id, remote_serial_id));
+  }
+}
+
 static std::vector<Pubkey> GetOrderedPubkeys(const Pubkey &a, const Pubkey &b) {
   return a.GetHex() < b.GetHex() ? std::vector<Pubkey>{a, b}
                                  : std::vector<Pubkey>{b, a};
@@ -306,12 +724,13 @@ void DlcManager::SignFundTransactionInput(
   const Txid &prev_tx_id,
   uint32_t prev_tx_vout,
   const Amount &value) {
+  auto pubkey = privkey.GeneratePubkey();
   auto raw_signature = GetRawFundingTransactionInputSignature(
-    *fund_transaction, privkey, prev_tx_id, prev_tx_vout, value);
+    *fund_transaction, privkey, pubkey, prev_tx_id, prev_tx_vout, value);
   auto hash_type = SigHashType(SigHashAlgorithm::kSigHashAll);
   auto signature = CryptoUtil::ConvertSignatureToDer(raw_signature, hash_type);
   fund_transaction->AddWitnessStack(
-    prev_tx_id, prev_tx_vout, signature.GetHex(), privkey.GeneratePubkey());
+    prev_tx_id, prev_tx_vout, signature.GetHex(), pubkey);
 }
 
 void DlcManager::AddSignatureToFundTransaction(
@@ -348,11 +767,8 @@ AdaptorPair DlcManager::CreateCetAdaptorSignature(
   const std::vector<ByteData256> &msgs) {
   auto adaptor_point =
     ComputeAdaptorPoint(msgs, oracle_r_values, oracle_pubkey);
-
-  auto sig_hash = cet.GetTransaction().GetSignatureHash(
-    0, funding_script_pubkey.GetData(), SigHashType(), total_collateral,
-    WitnessVersion::kVersion0);
-  return AdaptorUtil::Sign(sig_hash, funding_sk, adaptor_point);
+  return CreateAdaptorSignature(
+    cet, adaptor_point, funding_sk, funding_script_pubkey, total_collateral);
 }
 
 std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
@@ -362,7 +778,8 @@ std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
   const Privkey &funding_sk,
   const Script &funding_script_pubkey,
   const Amount &total_collateral,
-  const std::vector<std::vector<ByteData256>> &msgs) {
+  const std::vector<std::vector<ByteData256>> &msgs,
+  uint32_t nb_threads) {
   size_t nb = cets.size();
   if (nb != msgs.size()) {
     throw CfdException(
@@ -370,22 +787,29 @@ std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
       "Number of cets differ from number of messages");
   }
 
-  std::vector<AdaptorPair> sigs;
-  for (size_t i = 0; i < nb; i++) {
-    if (oracle_r_values.size() < msgs[i].size()) {
-      throw CfdException(
-        CfdError::kCfdIllegalArgumentError,
-        "Number of r values must be greater or equal to number of messages.");
-    }
-    std::vector<SchnorrPubkey> r_values;
-    for (size_t j = 0; j < msgs[i].size(); j++) {
-      r_values.push_back(oracle_r_values[j]);
-    }
-    sigs.push_back(CreateCetAdaptorSignature(
-      cets[i], oracle_pubkey, r_values, funding_sk, funding_script_pubkey,
-      total_collateral, msgs[i]));
+  // check all inputs before starting any worker.
+  for (const auto &cet_msgs : msgs) {
+    CheckNonceCount(oracle_r_values.size(), cet_msgs.size());
   }
 
+  CreateSecpContext();
+
+  CetMessageBuffer msg_buffer(msgs);
+  OracleNonceContext nonce_context(oracle_pubkey, oracle_r_values);
+  std::vector<Pubkey> adaptor_points(nb);
+  std::vector<AdaptorPair> sigs(nb);
+  RunInParallel(
+    nb, nb_threads,
+    [&](size_t begin, size_t end) {
+      ComputeAdaptorPointsInRange(
+        msg_buffer, begin, end, nonce_context, adaptor_points.data() + begin);
+      for (size_t i = begin; i < end; i++) {
+        sigs[i] = CreateAdaptorSignature(
+          cets[i], adaptor_points[i], funding_sk, funding_script_pubkey,
+          total_collateral);
+      }
+    });
+
   return sigs;
 }
 
@@ -400,12 +824,9 @@ bool DlcManager::VerifyCetAdaptorSignature(
   const std::vector<ByteData256> &msgs) {
   auto adaptor_point =
     ComputeAdaptorPoint(msgs, oracle_r_values, oracle_pubkey);
-  auto sig_hash = cet.GetTransaction().GetSignatureHash(
-    0, funding_script_pubkey.GetData(), SigHashType(), total_collateral,
-    WitnessVersion::kVersion0);
-  return AdaptorUtil::Verify(
-    adaptor_pair.signature, adaptor_pair.proof, adaptor_point, sig_hash,
-    pubkey);
+  return VerifyAdaptorSignature(
+    adaptor_pair, cet, pubkey, adaptor_point, funding_script_pubkey,
+    total_collateral);
 }
 
 bool DlcManager::VerifyCetAdaptorSignatures(
@@ -416,7 +837,9 @@ bool DlcManager::VerifyCetAdaptorSignatures(
   const SchnorrPubkey &oracle_pubkey,
   const std::vector<SchnorrPubkey> &oracle_r_values,
   const Script &funding_script_pubkey,
-  const Amount &total_collateral) {
+  const Amount &total_collateral,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
   auto nb = cets.size();
   if (nb != signature_and_proofs.size() || nb != msgs.size()) {
     throw CfdException(
@@ -424,24 +847,525 @@ bool DlcManager::VerifyCetAdaptorSignatures(
       "Number of transactions, signatures and messages differs.");
   }
 
-  bool all_valid = true;
+  for (const auto &cet_msgs : msgs) {
+    CheckNonceCount(oracle_r_values.size(), cet_msgs.size());
+  }
 
-  for (size_t i = 0; i < nb && all_valid; i++) {
-    if (oracle_r_values.size() < msgs[i].size()) {
-      throw CfdException(
-        CfdError::kCfdIllegalArgumentError,
-        "Number of r values must be greater or equal to number of messages.");
-    }
-    std::vector<SchnorrPubkey> r_values;
-    for (size_t j = 0; j < msgs[i].size(); j++) {
-      r_values.push_back(oracle_r_values[j]);
+  CreateSecpContext();
+
+  CetMessageBuffer msg_buffer(msgs);
+  auto nonce_context =
+    CreateVerificationNonceContext(oracle_pubkey, oracle_r_values, nb);
+  std::vector<Pubkey> adaptor_points(nb);
+  return VerifyInParallel(
+    nb, nb_threads,
+    [&](uint32_t, size_t begin, size_t end) {
+      ComputeAdaptorPointsInRange(
+        msg_buffer, begin, end, nonce_context, adaptor_points.data() + begin);
+      for (size_t i = begin; i < end; i++) {
+        if (!VerifyAdaptorSignature(
+              signature_and_proofs[i], cets[i], pubkey, adaptor_points[i],
+              funding_script_pubkey, total_collateral)) {
+          return i;
+        }
+      }
+      return end;
+    },
+    invalid_index);
+}
+
+AdaptorPair DlcManager::CreateCetAdaptorSignature(
+  const TransactionController &cet,
+  const OracleEventPointTable &point_table,
+  const Privkey &funding_sk,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral,
+  const std::vector<ByteData256> &msgs) {
+  auto adaptor_point = point_table.ComputeAdaptorPoint(msgs);
+  return CreateAdaptorSignature(
+    cet, adaptor_point, funding_sk, funding_script_pubkey, total_collateral);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<TransactionController> &cets,
+  const OracleEventPointTable &point_table,
+  const Privkey &funding_sk,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  uint32_t nb_threads) {
+  size_t nb = cets.size();
+  if (nb != msgs.size()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of cets differ from number of messages");
+  }
+
+  for (const auto &cet_msgs : msgs) {
+    CheckNonceCount(point_table.GetNonceCount(), cet_msgs.size());
+  }
+
+  CreateSecpContext();
+
+  CetMessageBuffer msg_buffer(msgs);
+  std::vector<Pubkey> adaptor_points(nb);
+  std::vector<AdaptorPair> sigs(nb);
+  RunInParallel(
+    nb, nb_threads,
+    [&](size_t begin, size_t end) {
+      ComputeAdaptorPointsInRange(
+        msg_buffer, begin, end, point_table, adaptor_points.data() + begin);
+      for (size_t i = begin; i < end; i++) {
+        sigs[i] = CreateAdaptorSignature(
+          cets[i], adaptor_points[i], funding_sk, funding_script_pubkey,
+          total_collateral);
+      }
+    });
+
+  return sigs;
+}
+
+bool DlcManager::VerifyCetAdaptorSignature(
+  const AdaptorPair &adaptor_pair,
+  const TransactionController &cet,
+  const Pubkey &pubkey,
+  const OracleEventPointTable &point_table,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral,
+  const std::vector<ByteData256> &msgs) {
+  auto adaptor_point = point_table.ComputeAdaptorPoint(msgs);
+  return VerifyAdaptorSignature(
+    adaptor_pair, cet, pubkey, adaptor_point, funding_script_pubkey,
+    total_collateral);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<TransactionController> &cets,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const Pubkey &pubkey,
+  const OracleEventPointTable &point_table,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  auto nb = cets.size();
+  if (nb != signature_and_proofs.size() || nb != msgs.size()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of transactions, signatures and messages differs.");
+  }
+
+  for (const auto &cet_msgs : msgs) {
+    CheckNonceCount(point_table.GetNonceCount(), cet_msgs.size());
+  }
+
+  CreateSecpContext();
+
+  CetMessageBuffer msg_buffer(msgs);
+  std::vector<Pubkey> adaptor_points(nb);
+  return VerifyInParallel(
+    nb, nb_threads,
+    [&](uint32_t, size_t begin, size_t end) {
+      ComputeAdaptorPointsInRange(
+        msg_buffer, begin, end, point_table, adaptor_points.data() + begin);
+      for (size_t i = begin; i < end; i++) {
+        if (!VerifyAdaptorSignature(
+              signature_and_proofs[i], cets[i], pubkey, adaptor_points[i],
+              funding_script_pubkey, total_collateral)) {
+          return i;
+        }
+      }
+      return end;
+    },
+    invalid_index);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &funding_sk,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  uint32_t nb_threads) {
+  return CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, oracle_pubkey, oracle_r_values, funding_sk,
+    CetMessageBuffer(msgs), nb_threads);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &funding_sk,
+  const CetMessageBuffer &msgs,
+  uint32_t nb_threads) {
+  CreateSecpContext();
+  return CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, OracleNonceContext(oracle_pubkey, oracle_r_values),
+    funding_sk, msgs, nb_threads);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const OracleNonceContext &nonce_context,
+  const Privkey &funding_sk,
+  const CetMessageBuffer &msgs,
+  uint32_t nb_threads) {
+  size_t nb = outcomes.size();
+  if (nb != msgs.GetCetCount()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of outcomes differ from number of messages");
+  }
+
+  for (size_t i = 0; i < nb; i++) {
+    CheckNonceCount(nonce_context.GetNonceCount(), msgs.GetMessageCount(i));
+  }
+
+  CreateSecpContext();
+
+  std::vector<Pubkey> adaptor_points(nb);
+  RunInParallel(nb, nb_threads, [&](size_t begin, size_t end) {
+    ComputeAdaptorPointsInRange(
+      msgs, begin, end, nonce_context, adaptor_points.data() + begin);
+  });
+
+  return CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_points, funding_sk, nb_threads);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<Pubkey> &adaptor_points,
+  const Privkey &funding_sk,
+  uint32_t nb_threads) {
+  size_t nb = outcomes.size();
+  if (nb != adaptor_points.size()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of outcomes differ from number of adaptor points");
+  }
+
+  CreateSecpContext();
+
+  std::vector<AdaptorPair> sigs(nb);
+  RunInParallel(nb, nb_threads, [&](size_t begin, size_t end) {
+    CetSignatureHasher::Buffers buffers;
+    for (size_t first = begin; first < end; first += kSigHashBatchSize) {
+      auto last = std::min(first + kSigHashBatchSize, end);
+      auto sig_hashes = sig_hasher.GetSignatureHashes(
+        outcomes.data() + first, last - first, &buffers);
+      for (size_t i = first; i < last; i++) {
+        sigs[i] = AdaptorUtil::Sign(
+          sig_hashes[i - first], funding_sk, adaptor_points[i]);
+      }
     }
-    all_valid &= VerifyCetAdaptorSignature(
-      signature_and_proofs[i], cets[i], pubkey, oracle_pubkey, r_values,
-      funding_script_pubkey, total_collateral, msgs[i]);
+  });
+
+  return sigs;
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const Pubkey &pubkey,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  return VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, signature_and_proofs, CetMessageBuffer(msgs),
+    pubkey, oracle_pubkey, oracle_r_values, nb_threads, invalid_index);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const CetMessageBuffer &msgs,
+  const Pubkey &pubkey,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  CreateSecpContext();
+  return VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, signature_and_proofs, msgs, pubkey,
+    CreateVerificationNonceContext(
+      oracle_pubkey, oracle_r_values, outcomes.size()),
+    nb_threads, invalid_index);
+}
+
+OracleNonceContext DlcManager::CreateVerificationNonceContext(
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  size_t nb_cets) {
+  if (nb_cets < kPubkeyTableMinMultiplications) {
+    return OracleNonceContext(oracle_pubkey, oracle_r_values);
   }
+  return OracleNonceContext(
+    std::make_shared<const OraclePubkeyTable>(oracle_pubkey),
+    oracle_r_values);
+}
 
-  return all_valid;
+bool DlcManager::VerifyCetAdaptorSignature(
+  const AdaptorPair &adaptor_pair,
+  const TransactionController &cet,
+  const Pubkey &pubkey,
+  const OracleNonceContext &nonce_context,
+  const Script &funding_script_pubkey,
+  const Amount &total_collateral,
+  const std::vector<ByteData256> &msgs) {
+  auto adaptor_point = nonce_context.ComputeAdaptorPoint(msgs);
+  return VerifyAdaptorSignature(
+    adaptor_pair, cet, pubkey, adaptor_point, funding_script_pubkey,
+    total_collateral);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const CetMessageBuffer &msgs,
+  const Pubkey &pubkey,
+  const OracleNonceContext &nonce_context,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  auto nb = outcomes.size();
+  if (nb != signature_and_proofs.size() || nb != msgs.GetCetCount()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of outcomes, signatures and messages differs.");
+  }
+
+  return VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, signature_and_proofs, 0, msgs, pubkey,
+    nonce_context, nb_threads, invalid_index);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  size_t begin,
+  const CetMessageBuffer &msgs,
+  const Pubkey &pubkey,
+  const OracleNonceContext &nonce_context,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  auto nb = signature_and_proofs.size();
+  if (outcomes.size() != msgs.GetCetCount() || begin > outcomes.size() ||
+      nb > outcomes.size() - begin) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Signatures out of the range of the outcomes and messages.");
+  }
+
+  for (size_t i = begin; i < begin + nb; i++) {
+    CheckNonceCount(nonce_context.GetNonceCount(), msgs.GetMessageCount(i));
+  }
+
+  CreateSecpContext();
+
+  // the workers index the signatures of the range from 0, the outcomes and
+  // messages from begin.
+  std::vector<Pubkey> adaptor_points(nb);
+  std::vector<CetSignatureHasher::Buffers> buffers(
+    GetWorkerCount(nb_threads, nb));
+  size_t first_invalid = nb;
+  auto is_valid = VerifyInParallel(
+    nb, nb_threads,
+    [&](uint32_t worker_index, size_t first, size_t last) {
+      auto *points = adaptor_points.data() + first;
+      ComputeAdaptorPointsInRange(
+        msgs, begin + first, begin + last, nonce_context, points);
+      auto invalid = VerifyOutcomeSignaturesInRange(
+        outcomes, sig_hasher, signature_and_proofs.data() + first, points,
+        pubkey, begin + first, begin + last, &buffers[worker_index]);
+      return invalid - begin;
+    },
+    &first_invalid);
+  if (invalid_index != nullptr) {
+    *invalid_index = begin + first_invalid;
+  }
+  return is_valid;
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const std::vector<Pubkey> &adaptor_points,
+  const Pubkey &pubkey,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  auto nb = outcomes.size();
+  if (nb != signature_and_proofs.size() || nb != adaptor_points.size()) {
+    throw CfdException(
+      CfdError::kCfdIllegalArgumentError,
+      "Number of outcomes, signatures and adaptor points differs.");
+  }
+
+  CreateSecpContext();
+
+  std::vector<CetSignatureHasher::Buffers> buffers(
+    GetWorkerCount(nb_threads, nb));
+  return VerifyInParallel(
+    nb, nb_threads,
+    [&](uint32_t worker_index, size_t begin, size_t end) {
+      return VerifyOutcomeSignaturesInRange(
+        outcomes, sig_hasher, signature_and_proofs.data() + begin,
+        adaptor_points.data() + begin, pubkey, begin, end,
+        &buffers[worker_index]);
+    },
+    invalid_index);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const CetMessageBuffer &msgs,
+  const DlcCryptoContext &context,
+  uint32_t nb_threads) {
+  return CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, context.GetNonceContext(),
+    context.GetLocalFundPrivkey(), msgs, nb_threads);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<DlcOutcome> &outcomes,
+  const CetSignatureHasher &sig_hasher,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const CetMessageBuffer &msgs,
+  const DlcCryptoContext &context,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  return VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, signature_and_proofs, msgs,
+    context.GetRemoteFundPubkey(), context.GetNonceContext(), nb_threads,
+    invalid_index);
+}
+
+AdaptorPair DlcManager::CreateCetAdaptorSignature(
+  const TransactionController &cet,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &funding_sk,
+  const DlcContractContext &contract,
+  const std::vector<ByteData256> &msgs) {
+  return CreateCetAdaptorSignature(
+    cet, oracle_pubkey, oracle_r_values, funding_sk,
+    contract.GetFundLockingScript(), contract.GetFundAmount(), msgs);
+}
+
+std::vector<AdaptorPair> DlcManager::CreateCetAdaptorSignatures(
+  const std::vector<TransactionController> &cets,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const Privkey &funding_sk,
+  const DlcContractContext &contract,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  uint32_t nb_threads) {
+  return CreateCetAdaptorSignatures(
+    cets, oracle_pubkey, oracle_r_values, funding_sk,
+    contract.GetFundLockingScript(), contract.GetFundAmount(), msgs,
+    nb_threads);
+}
+
+bool DlcManager::VerifyCetAdaptorSignature(
+  const AdaptorPair &adaptor_pair,
+  const TransactionController &cet,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const DlcContractContext &contract,
+  bool verify_remote,
+  const std::vector<ByteData256> &msgs) {
+  const auto &pubkey = verify_remote ? contract.GetRemoteFundPubkey()
+                                     : contract.GetLocalFundPubkey();
+  return VerifyCetAdaptorSignature(
+    adaptor_pair, cet, pubkey, oracle_pubkey, oracle_r_values,
+    contract.GetFundLockingScript(), contract.GetFundAmount(), msgs);
+}
+
+bool DlcManager::VerifyCetAdaptorSignatures(
+  const std::vector<TransactionController> &cets,
+  const std::vector<AdaptorPair> &signature_and_proofs,
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const SchnorrPubkey &oracle_pubkey,
+  const std::vector<SchnorrPubkey> &oracle_r_values,
+  const DlcContractContext &contract,
+  bool verify_remote,
+  uint32_t nb_threads,
+  size_t *invalid_index) {
+  const auto &pubkey = verify_remote ? contract.GetRemoteFundPubkey()
+                                     : contract.GetLocalFundPubkey();
+  return VerifyCetAdaptorSignatures(
+    cets, signature_and_proofs, msgs, pubkey, oracle_pubkey, oracle_r_values,
+    contract.GetFundLockingScript(), contract.GetFundAmount(), nb_threads,
+    invalid_index);
+}
+
+std::vector<Pubkey> DlcManager::ComputeAdaptorPoints(
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const std::vector<SchnorrPubkey> &r_values,
+  const SchnorrPubkey &pubkey) {
+  return ComputeAdaptorPoints(msgs, OracleNonceContext(pubkey, r_values));
+}
+
+std::vector<Pubkey> DlcManager::ComputeAdaptorPoints(
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const OracleNonceContext &nonce_context) {
+  return ComputeAdaptorPoints(CetMessageBuffer(msgs), nonce_context);
+}
+
+std::vector<Pubkey> DlcManager::ComputeAdaptorPoints(
+  const CetMessageBuffer &msgs, const OracleNonceContext &nonce_context) {
+  size_t nb = msgs.GetCetCount();
+  for (size_t i = 0; i < nb; i++) {
+    CheckNonceCount(nonce_context.GetNonceCount(), msgs.GetMessageCount(i));
+  }
+  std::vector<Pubkey> adaptor_points(nb);
+  ComputeAdaptorPointsInRange(
+    msgs, 0, nb, nonce_context, adaptor_points.data());
+  return adaptor_points;
+}
+
+std::vector<Pubkey> DlcManager::ComputeAdaptorPoints(
+  const std::vector<std::vector<ByteData256>> &msgs,
+  const OracleEventPointTable &point_table) {
+  for (const auto &cet_msgs : msgs) {
+    CheckNonceCount(point_table.GetNonceCount(), cet_msgs.size());
+  }
+  std::vector<Pubkey> adaptor_points(msgs.size());
+  ComputeAdaptorPointsInRange(
+    CetMessageBuffer(msgs), 0, msgs.size(), point_table,
+    adaptor_points.data());
+  return adaptor_points;
+}
+
+/**
+ * @brief Check whether a public key is the first one of a 2-of-2 multisig
+ * script.
+ */
+static bool IsFirstMultisigPubkey(
+  const Script &multisig_script, const Pubkey &pubkey) {
+  auto pubkeys = ScriptUtil::ExtractPubkeysFromMultisigScript(multisig_script);
+  auto pubkey_hex = pubkey.GetHex();
+  if (pubkey_hex == pubkeys[0].GetHex()) {
+    return true;
+  } else if (pubkey_hex == pubkeys[1].GetHex()) {
+    return false;
+  }
+  throw CfdException(
+    CfdError::kCfdIllegalArgumentError,
+    "Public key not part of the multi sig script.");
 }
 
 void DlcManager::SignCet(
@@ -453,6 +1377,49 @@ void DlcManager::SignCet(
   const Txid &fund_tx_id,
   uint32_t fund_vout,
   const Amount &fund_amount) {
+  SignCet(
+    cet, adaptor_sig, oracle_signatures, funding_sk,
+    IsFirstMultisigPubkey(funding_script_pubkey, funding_sk.GetPubkey()),
+    funding_script_pubkey, fund_tx_id, fund_vout, fund_amount);
+}
+
+void DlcManager::SignCet(
+  TransactionController *cet,
+  const AdaptorSignature &adaptor_sig,
+  const std::vector<SchnorrSignature> &oracle_signatures,
+  const DlcCryptoContext &context,
+  const Script &funding_script_pubkey,
+  const Txid &fund_tx_id,
+  uint32_t fund_vout,
+  const Amount &fund_amount) {
+  SignCet(
+    cet, adaptor_sig, oracle_signatures, context.GetLocalFundPrivkey(),
+    context.IsLocalPubkeyFirst(), funding_script_pubkey, fund_tx_id,
+    fund_vout, fund_amount);
+}
+
+void DlcManager::SignCet(
+  TransactionController *cet,
+  const AdaptorSignature &adaptor_sig,
+  const std::vector<SchnorrSignature> &oracle_signatures,
+  const Privkey &funding_sk,
+  const DlcContractContext &contract) {
+  SignCet(
+    cet, adaptor_sig, oracle_signatures, funding_sk,
+    contract.IsLocalPubkeyFirst(), contract.GetFundLockingScript(),
+    contract.GetFundTxId(), contract.GetFundVout(), contract.GetFundAmount());
+}
+
+void DlcManager::SignCet(
+  TransactionController *cet,
+  const AdaptorSignature &adaptor_sig,
+  const std::vector<SchnorrSignature> &oracle_signatures,
+  const Privkey &funding_sk,
+  bool is_own_first,
+  const Script &funding_script_pubkey,
+  const Txid &fund_tx_id,
+  uint32_t fund_vout,
+  const Amount &fund_amount) {
   if (oracle_signatures.size() < 1) {
     throw CfdException(
       CfdError::kCfdIllegalArgumentError, "No oracle signature provided.");
@@ -470,21 +1437,14 @@ void DlcManager::SignCet(
     0, funding_script_pubkey.GetData(), SigHashType(), fund_amount,
     WitnessVersion::kVersion0);
   auto own_sig = SignatureUtil::CalculateEcSignature(sig_hash, funding_sk);
-  auto pubkeys =
-    ScriptUtil::ExtractPubkeysFromMultisigScript(funding_script_pubkey);
-  auto own_pubkey_hex = funding_sk.GetPubkey().GetHex();
-  if (own_pubkey_hex == pubkeys[0].GetHex()) {
+  if (is_own_first) {
     AddSignaturesForMultiSigInput(
       cet, fund_tx_id, fund_vout, funding_script_pubkey,
       {own_sig, adapted_sig});
-  } else if (own_pubkey_hex == pubkeys[1].GetHex()) {
+  } else {
     AddSignaturesForMultiSigInput(
       cet, fund_tx_id, fund_vout, funding_script_pubkey,
       {adapted_sig, own_sig});
-  } else {
-    throw new CfdException(
-      CfdError::kCfdIllegalArgumentError,
-      "Public key not part of the multi sig script.");
   }
 }
 
@@ -494,9 +1454,21 @@ ByteData DlcManager::GetRawFundingTransactionInputSignature(
   const Txid &prev_tx_id,
   uint32_t prev_tx_vout,
   const Amount &value) {
+  return GetRawFundingTransactionInputSignature(
+    funding_transaction, privkey, privkey.GeneratePubkey(), prev_tx_id,
+    prev_tx_vout, value);
+}
+
+ByteData DlcManager::GetRawFundingTransactionInputSignature(
+  const TransactionController &funding_transaction,
+  const Privkey &privkey,
+  const Pubkey &pubkey,
+  const Txid &prev_tx_id,
+  uint32_t prev_tx_vout,
+  const Amount &value) {
   auto hash_type = SigHashType();
   auto sig_hash_str = funding_transaction.CreateSignatureHash(
-    prev_tx_id, prev_tx_vout, privkey.GeneratePubkey(), hash_type, value,
+    prev_tx_id, prev_tx_vout, pubkey, hash_type, value,
     WitnessVersion::kVersion0);
   auto sig_hash = ByteData256(sig_hash_str);
   return SignatureUtil::CalculateEcSignature(sig_hash, privkey);
@@ -612,6 +1584,41 @@ ByteData DlcManager::GetRawRefundTxSignature(
     refund_tx, privkey, script, input_amount, fund_tx_id, fund_tx_vout);
 }
 
+ByteData DlcManager::GetRawRefundTxSignature(
+  const TransactionController &refund_tx,
+  const Privkey &privkey,
+  const DlcContractContext &contract) {
+  return GetRawRefundTxSignature(
+    refund_tx, privkey, contract.GetFundLockingScript(),
+    contract.GetFundAmount(), contract.GetFundTxId(), contract.GetFundVout());
+}
+
+void DlcManager::AddSignaturesToRefundTx(
+  TransactionController *refund_tx,
+  const DlcContractContext &contract,
+  const ByteData &local_signature,
+  const ByteData &remote_signature) {
+  std::vector<ByteData> signatures = {local_signature, remote_signature};
+  if (!contract.IsLocalPubkeyFirst()) {
+    std::swap(signatures[0], signatures[1]);
+  }
+  AddSignaturesToRefundTx(
+    refund_tx, contract.GetFundLockingScript(), signatures,
+    contract.GetFundTxId(), contract.GetFundVout());
+}
+
+bool DlcManager::VerifyRefundTxSignature(
+  const TransactionController &refund_tx,
+  const ByteData &signature,
+  const DlcContractContext &contract,
+  bool verify_remote) {
+  const auto &pubkey = verify_remote ? contract.GetRemoteFundPubkey()
+                                     : contract.GetLocalFundPubkey();
+  return VerifyRefundTxSignature(
+    refund_tx, signature, pubkey, contract.GetFundLockingScript(),
+    contract.GetFundAmount(), contract.GetFundTxId(), contract.GetFundVout());
+}
+
 DlcTransactions DlcManager::CreateDlcTransactions(
   const std::vector<DlcOutcome> &outcomes,
   const PartyParams &local_params,
@@ -623,9 +1630,32 @@ DlcTransactions DlcManager::CreateDlcTransactions(
   uint64_t fund_lock_time,
   uint64_t cet_lock_time,
   uint64_t fund_output_serial_id) {
+  std::vector<TransactionController> cets;
+  cets.reserve(outcomes.size());
+  auto transactions = CreateDlcTransactions(
+    outcomes, local_params, remote_params, refund_locktime, fee_rate,
+    [&cets](size_t, const TransactionController &cet) { cets.push_back(cet); },
+    option_dest, option_premium, fund_lock_time, cet_lock_time,
+    fund_output_serial_id);
+  transactions.cets = std::move(cets);
+  return transactions;
+}
+
+DlcTransactions DlcManager::CreateDlcTransactions(
+  const std::vector<DlcOutcome> &outcomes,
+  const PartyParams &local_params,
+  const PartyParams &remote_params,
+  uint64_t refund_locktime,
+  uint32_t fee_rate,
+  const CetHandler &cet_handler,
+  const Address &option_dest,
+  const Amount &option_premium,
+  uint64_t fund_lock_time,
+  uint64_t cet_lock_time,
+  uint64_t fund_output_serial_id) {
   auto total_collateral = local_params.collateral + remote_params.collateral;
 
-  for (auto outcome : outcomes) {
+  for (const auto &outcome : outcomes) {
     if (outcome.local_payout + outcome.remote_payout != total_collateral) {
       throw CfdException(
         CfdError::kCfdIllegalArgumentError,
@@ -694,9 +1724,9 @@ DlcTransactions DlcManager::CreateDlcTransactions(
     }
   }
 
-  auto cets = CreateCets(
+  CreateCets(
     fund_tx_id, fund_vout, local_params.final_script_pubkey,
-    remote_params.final_script_pubkey, outcomes, cet_lock_time,
+    remote_params.final_script_pubkey, outcomes, cet_handler, cet_lock_time,
     local_params.payout_serial_id, remote_params.payout_serial_id);
 
   auto refund_tx = CreateRefundTransaction(
@@ -704,7 +1734,7 @@ DlcTransactions DlcManager::CreateDlcTransactions(
     local_params.collateral, remote_params.collateral, refund_locktime,
     fund_tx_id, fund_vout);
 
-  return {fund_tx, cets, refund_tx};
+  return {fund_tx, {}, refund_tx};
 }
 
 BatchDlcTransactions DlcManager::CreateBatchDlcTransactions(
@@ -984,11 +2014,208 @@ Pubkey DlcManager::ComputeAdaptorPoint(
       "Number of r values and messages must match.");
   }
 
-  if (msgs.size() == 1) {
-    return SchnorrUtil::ComputeSigPoint(msgs[0], r_values[0], pubkey);
+  return OracleNonceContext(pubkey, r_values).ComputeAdaptorPoint(msgs);
+}
+
+/**
+ * @brief Offsets in a serialized CET of the outpoint and of the sequence of
+ * its single input (whose script sig is empty), and of its first output.
+ */
+static const size_t kCetOutpointOffset = 4 + 1;
+static const size_t kCetSequenceOffset = kCetOutpointOffset + 36 + 1;
+static const size_t kCetOutputsOffset = kCetSequenceOffset + 4 + 1;
+
+/**
+ * @brief Write an amount in little endian at the given position.
+ */
+static void WriteAmount(const Amount &amount, uint8_t *out) {
+  auto value = static_cast<uint64_t>(amount.GetSatoshiValue());
+  for (size_t i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+CetTemplate::CetTemplate(
+  const Txid &fund_tx_id,
+  uint32_t fund_vout,
+  const Script &local_final_script_pubkey,
+  const Script &remote_final_script_pubkey,
+  uint32_t lock_time,
+  uint64_t local_serial_id,
+  uint64_t remote_serial_id) {
+  // Build a reference CET for each set of outputs, using distinct payouts so
+  // that the outputs can be told apart whatever their order.
+  for (uint32_t index = 0; index < 4; index++) {
+    bool is_local_dust = (index & 1) != 0;
+    bool is_remote_dust = (index & 2) != 0;
+    auto local_payout = Amount::CreateBySatoshiAmount(
+      is_local_dust ? 0 : static_cast<int64_t>(DUST_LIMIT));
+    auto remote_payout = Amount::CreateBySatoshiAmount(
+      is_remote_dust ? 0 : static_cast<int64_t>(DUST_LIMIT + 1));
+    auto cet = DlcManager::CreateCet(
+      TxOut(local_payout, local_final_script_pubkey),
+      TxOut(remote_payout, remote_final_script_pubkey), fund_tx_id, fund_vout,
+      lock_time, local_serial_id, remote_serial_id);
+
+    const auto &tx = cet.GetTransaction();
+    auto &layout = layouts_[index];
+    layout.bytes = tx.GetData().GetBytes();
+    layout.local_offset = 0;
+    layout.remote_offset = 0;
+    size_t offset = kCetOutputsOffset;
+    for (uint32_t i = 0; i < tx.GetTxOutCount(); i++) {
+      auto txout = tx.GetTxOut(i);
+      if (txout.GetValue() == local_payout) {
+        layout.local_offset = offset;
+      } else {
+        layout.remote_offset = offset;
+      }
+      std::fill_n(layout.bytes.begin() + offset, 8, 0);
+      auto script = txout.GetLockingScript().GetData().Serialize();
+      offset += 8 + script.GetDataSize();
+    }
+  }
+}
+
+const CetTemplate::Layout &CetTemplate::GetLayout(
+  const DlcOutcome &outcome) const {
+  size_t index = 0;
+  if (outcome.local_payout < DUST_LIMIT) {
+    index |= 1;
   }
+  if (outcome.remote_payout < DUST_LIMIT) {
+    index |= 2;
+  }
+  return layouts_[index];
+}
 
-  return SchnorrUtil::ComputeSigPointBatch(msgs, r_values, pubkey);
+void CetTemplate::SerializeCet(
+  const DlcOutcome &outcome, std::vector<uint8_t> *cet) const {
+  const auto &layout = GetLayout(outcome);
+  cet->assign(layout.bytes.begin(), layout.bytes.end());
+  if (layout.local_offset != 0) {
+    WriteAmount(outcome.local_payout, cet->data() + layout.local_offset);
+  }
+  if (layout.remote_offset != 0) {
+    WriteAmount(outcome.remote_payout, cet->data() + layout.remote_offset);
+  }
 }
+
+void CetTemplate::SerializeOutputs(
+  const DlcOutcome &outcome, std::vector<uint8_t> *outputs) const {
+  const auto &layout = GetLayout(outcome);
+  outputs->assign(
+    layout.bytes.begin() + kCetOutputsOffset, layout.bytes.end() - 4);
+  if (layout.local_offset != 0) {
+    WriteAmount(
+      outcome.local_payout,
+      outputs->data() + layout.local_offset - kCetOutputsOffset);
+  }
+  if (layout.remote_offset != 0) {
+    WriteAmount(
+      outcome.remote_payout,
+      outputs->data() + layout.remote_offset - kCetOutputsOffset);
+  }
+}
+
+ByteData CetTemplate::SerializeCet(const DlcOutcome &outcome) const {
+  std::vector<uint8_t> cet;
+  SerializeCet(outcome, &cet);
+  return ByteData(cet);
+}
+
+TransactionController CetTemplate::CreateCet(const DlcOutcome &outcome) const {
+  return TransactionController(SerializeCet(outcome).GetHex());
+}
+
+/**
+ * @brief Get a new id for a CetSignatureHasher. Ids are never reused, unlike
+ * the addresses of hashers created one after another on the stack.
+ */
+static uint64_t GetNextHasherId() {
+  static std::atomic<uint64_t> next_id(1);
+  return next_id.fetch_add(1);
+}
+
+CetSignatureHasher::CetSignatureHasher(
+  const CetTemplate &cet_template,
+  const Script &funding_script_pubkey,
+  const Amount &fund_output_amount)
+    : cet_template_(cet_template), id_(GetNextHasherId()) {
+  // all layouts share the same version, input and lock time.
+  std::vector<uint8_t> cet;
+  cet_template.SerializeCet(DlcOutcome(), &cet);
+  auto version = cet.begin();
+  auto outpoint = cet.begin() + kCetOutpointOffset;
+  auto sequence = cet.begin() + kCetSequenceOffset;
+  auto lock_time = cet.end() - 4;
+
+  auto hash_prevouts = HashUtil::Sha256D(
+    std::vector<uint8_t>(outpoint, outpoint + 36)).GetBytes();
+  auto hash_sequence = HashUtil::Sha256D(
+    std::vector<uint8_t>(sequence, sequence + 4)).GetBytes();
+  auto script_code = funding_script_pubkey.GetData().Serialize().GetBytes();
+  uint8_t amount[8];
+  WriteAmount(fund_output_amount, amount);
+
+  preimage_.insert(preimage_.end(), version, version + 4);
+  preimage_.insert(preimage_.end(), hash_prevouts.begin(), hash_prevouts.end());
+  preimage_.insert(preimage_.end(), hash_sequence.begin(), hash_sequence.end());
+  preimage_.insert(preimage_.end(), outpoint, outpoint + 36);
+  preimage_.insert(preimage_.end(), script_code.begin(), script_code.end());
+  preimage_.insert(preimage_.end(), amount, amount + 8);
+  preimage_.insert(preimage_.end(), sequence, sequence + 4);
+  hash_outputs_offset_ = preimage_.size();
+  preimage_.resize(preimage_.size() + 32);
+  preimage_.insert(preimage_.end(), lock_time, lock_time + 4);
+  // SIGHASH_ALL
+  const uint8_t sighash_type[4] = {1, 0, 0, 0};
+  preimage_.insert(preimage_.end(), sighash_type, sighash_type + 4);
+}
+
+ByteData256 CetSignatureHasher::GetSignatureHash(
+  const DlcOutcome &outcome) const {
+  std::vector<uint8_t> outputs;
+  cet_template_.SerializeOutputs(outcome, &outputs);
+  auto hash_outputs = HashUtil::Sha256D(outputs).GetBytes();
+
+  auto preimage = preimage_;
+  std::copy(
+    hash_outputs.begin(), hash_outputs.end(),
+    preimage.begin() + hash_outputs_offset_);
+  return HashUtil::Sha256D(preimage);
+}
+
+std::vector<ByteData256> CetSignatureHasher::GetSignatureHashes(
+  const std::vector<DlcOutcome> &outcomes) const {
+  Buffers buffers;
+  return GetSignatureHashes(outcomes.data(), outcomes.size(), &buffers);
+}
+
+std::vector<ByteData256> CetSignatureHasher::GetSignatureHashes(
+  const DlcOutcome *outcomes, size_t nb_outcomes, Buffers *buffers) const {
+  auto &outputs = buffers->outputs;
+  outputs.resize(nb_outcomes);
+  for (size_t i = 0; i < nb_outcomes; i++) {
+    cet_template_.SerializeOutputs(outcomes[i], &outputs[i]);
+  }
+  auto hash_outputs = BatchHashUtil::Sha256D(outputs);
+
+  // the preimages only differ by the hash of the outputs, so the ones filled
+  // by a previous batch of this hasher are kept.
+  auto &preimages = buffers->preimages;
+  if (buffers->hasher_id != id_) {
+    preimages.clear();
+    buffers->hasher_id = id_;
+  }
+  preimages.resize(nb_outcomes, preimage_);
+  for (size_t i = 0; i < nb_outcomes; i++) {
+    auto hash = hash_outputs[i].GetBytes();
+    std::copy(
+      hash.begin(), hash.end(), preimages[i].begin() + hash_outputs_offset_);
+  }
+  return BatchHashUtil::Sha256D(preimages);
+}
+
 }  // namespace dlc
 }  // namespace cfd
@@ -0,0 +1,151 @@
+// Copyright 2020 CryptoGarage
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_context.h"
+#include "cfddlc/cfddlc_transactions.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::Script;
+using cfd::Txid;
+using cfd::core::ByteData256;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+using cfd::core::SignatureUtil;
+
+using cfd::dlc::CetMessageBuffer;
+using cfd::dlc::CetSignatureHasher;
+using cfd::dlc::CetTemplate;
+using cfd::dlc::DlcCryptoContext;
+using cfd::dlc::DlcManager;
+using cfd::dlc::DlcOutcome;
+using cfd::dlc::OraclePubkeyTable;
+
+const SchnorrPubkey ORACLE_PUBKEY = SchnorrPubkey::FromPrivkey(Privkey(
+  "ded9a76a0a77399e1c2676324118a0386004633f16245ad30d172b15c1f9e2d3"));
+const std::vector<SchnorrPubkey> ORACLE_R_VALUES = {
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "be3cc8de25c50e25f69e2f88d151e3f63e99c3a44fed2bdd2e3ee70fe141c5c3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "9e1bc6dc95ce931903cc2df67640cf6cca94ddd96aab0b847780d644e46cfae3"))};
+const Privkey LOCAL_FUND_PRIVKEY(
+  "0000000000000000000000000000000000000000000000000000000000000001");
+const Privkey REMOTE_FUND_PRIVKEY(
+  "0000000000000000000000000000000000000000000000000000000000000002");
+const Amount TOTAL_COLLATERAL = Amount::CreateBySatoshiAmount(200000000);
+
+TEST(DlcCryptoContext, InitializeSecpContextIsIdempotent) {
+  EXPECT_NO_THROW(DlcCryptoContext::InitializeSecpContext());
+  EXPECT_NO_THROW(DlcCryptoContext::InitializeSecpContext());
+
+  // signing is unchanged by the randomization of the shared context.
+  auto msg = HashUtil::Sha256("initialize");
+  auto pubkey = LOCAL_FUND_PRIVKEY.GeneratePubkey();
+  auto sig = SignatureUtil::CalculateEcSignature(msg, LOCAL_FUND_PRIVKEY);
+  EXPECT_TRUE(SignatureUtil::VerifyEcSignature(msg, pubkey, sig));
+}
+
+TEST(DlcCryptoContext, KeysAreDerivedOnce) {
+  DlcCryptoContext context(
+    ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    REMOTE_FUND_PRIVKEY.GeneratePubkey());
+  EXPECT_EQ(
+    LOCAL_FUND_PRIVKEY.GeneratePubkey().GetHex(),
+    context.GetLocalFundPubkey().GetHex());
+  EXPECT_EQ(
+    LOCAL_FUND_PRIVKEY.GetHex(), context.GetLocalFundPrivkey().GetHex());
+  EXPECT_EQ(
+    REMOTE_FUND_PRIVKEY.GeneratePubkey().GetHex(),
+    context.GetRemoteFundPubkey().GetHex());
+  EXPECT_EQ(
+    ORACLE_PUBKEY.GetHex(),
+    context.GetNonceContext().GetOraclePubkey().GetHex());
+  EXPECT_EQ(
+    ORACLE_R_VALUES.size(), context.GetNonceContext().GetNonceCount());
+
+  DlcCryptoContext remote_context(
+    ORACLE_PUBKEY, ORACLE_R_VALUES, REMOTE_FUND_PRIVKEY,
+    LOCAL_FUND_PRIVKEY.GeneratePubkey());
+  EXPECT_NE(context.IsLocalPubkeyFirst(), remote_context.IsLocalPubkeyFirst());
+}
+
+TEST(DlcCryptoContext, CetAdaptorSignatures) {
+  std::vector<DlcOutcome> outcomes;
+  std::vector<std::vector<ByteData256>> msgs;
+  for (size_t i = 0; i < 20; i++) {
+    auto local_payout =
+      Amount::CreateBySatoshiAmount(static_cast<int64_t>(i) * 10000000);
+    outcomes.push_back({local_payout, TOTAL_COLLATERAL - local_payout});
+    msgs.push_back(
+      {HashUtil::Sha256("outcome " + std::to_string(i)),
+       HashUtil::Sha256("unit " + std::to_string(i % 3))});
+  }
+  CetMessageBuffer buffer(msgs);
+
+  auto local_fund_pubkey = LOCAL_FUND_PRIVKEY.GeneratePubkey();
+  auto remote_fund_pubkey = REMOTE_FUND_PRIVKEY.GeneratePubkey();
+  CetSignatureHasher sig_hasher(
+    CetTemplate(
+      Txid("83266d6b22a9babf6ee469b88fd0d3a0c690525f7c903aff22ec8ee44214604f"),
+      0, Script("0014e8b9b1ab4c1cd3f76bcd8e5bdac28ef3e22e84b7"),
+      Script("0014c3a7d6e3b3e2a2e1f9e9b6d07c6a3cb0f3fd0b55")),
+    DlcManager::CreateFundTxLockingScript(
+      local_fund_pubkey, remote_fund_pubkey),
+    TOTAL_COLLATERAL);
+
+  DlcCryptoContext local_context(
+    ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY, remote_fund_pubkey);
+  DlcCryptoContext remote_context(
+    std::make_shared<const OraclePubkeyTable>(ORACLE_PUBKEY), ORACLE_R_VALUES,
+    REMOTE_FUND_PRIVKEY, local_fund_pubkey);
+
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    buffer);
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, buffer, local_context, 2);
+  ASSERT_EQ(expected.size(), adaptor_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      adaptor_pairs[i].signature.GetData().GetHex());
+  }
+
+  size_t invalid_index = 0;
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, remote_context, 2,
+    &invalid_index));
+  EXPECT_EQ(outcomes.size(), invalid_index);
+  // the local context verifies against the remote funding key.
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, local_context));
+
+  std::swap(adaptor_pairs[3], adaptor_pairs[7]);
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, remote_context, 1,
+    &invalid_index));
+  EXPECT_EQ(static_cast<size_t>(3), invalid_index);
+
+  DlcCryptoContext short_context(
+    ORACLE_PUBKEY, {ORACLE_R_VALUES[0]}, LOCAL_FUND_PRIVKEY,
+    remote_fund_pubkey);
+  EXPECT_THROW(
+    DlcManager::CreateCetAdaptorSignatures(
+      outcomes, sig_hasher, buffer, short_context),
+    CfdException);
+  outcomes.pop_back();
+  EXPECT_THROW(
+    DlcManager::CreateCetAdaptorSignatures(
+      outcomes, sig_hasher, buffer, local_context),
+    CfdException);
+}
@@ -0,0 +1,330 @@
+// Copyright 2020 CryptoGarage
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "cfddlc_field.h"  // NOLINT
+#include "gtest/gtest.h"
+
+using cfd::dlc::FieldAdd;
+using cfd::dlc::FieldElement;
+using cfd::dlc::FieldFromBytes;
+using cfd::dlc::FieldInv;
+using cfd::dlc::FieldIsZero;
+using cfd::dlc::FieldMul;
+using cfd::dlc::FieldReduce;
+using cfd::dlc::FieldSqr;
+using cfd::dlc::FieldSub;
+using cfd::dlc::FieldToBytes;
+using cfd::dlc::kFieldPrime;
+using cfd::dlc::MulAdd;
+using cfd::dlc::MulAddPortable;
+
+// Reference arithmetic on 32 bit limbs, computing a product by doubling and
+// adding, independently of the 64 bit limbs implementation.
+using Limbs32 = std::array<uint32_t, 8>;
+
+static Limbs32 ToLimbs32(const FieldElement &a) {
+  Limbs32 r;
+  for (size_t i = 0; i < 4; i++) {
+    r[2 * i] = static_cast<uint32_t>(a[i]);
+    r[2 * i + 1] = static_cast<uint32_t>(a[i] >> 32);
+  }
+  return r;
+}
+
+static FieldElement FromLimbs32(const Limbs32 &a) {
+  FieldElement r;
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = a[2 * i] | (static_cast<uint64_t>(a[2 * i + 1]) << 32);
+  }
+  return r;
+}
+
+static const Limbs32 kPrime32 = ToLimbs32(kFieldPrime);
+
+static bool RefIsLess(const Limbs32 &a, const Limbs32 &b) {
+  for (size_t i = 8; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i];
+    }
+  }
+  return false;
+}
+
+// a - b mod 2^256.
+static Limbs32 RefWrappingSub(const Limbs32 &a, const Limbs32 &b) {
+  Limbs32 r;
+  int64_t borrow = 0;
+  for (size_t i = 0; i < 8; i++) {
+    int64_t diff = static_cast<int64_t>(a[i]) - b[i] - borrow;
+    borrow = (diff < 0) ? 1 : 0;
+    r[i] = static_cast<uint32_t>(diff);
+  }
+  return r;
+}
+
+static Limbs32 RefReduce(const Limbs32 &a) {
+  return RefIsLess(a, kPrime32) ? a : RefWrappingSub(a, kPrime32);
+}
+
+static Limbs32 RefAdd(const Limbs32 &a, const Limbs32 &b) {
+  Limbs32 r;
+  uint64_t carry = 0;
+  for (size_t i = 0; i < 8; i++) {
+    uint64_t sum = static_cast<uint64_t>(a[i]) + b[i] + carry;
+    r[i] = static_cast<uint32_t>(sum);
+    carry = sum >> 32;
+  }
+  // subtracting p mod 2^256 also gives a + b - p when the sum wrapped.
+  if (carry != 0 || !RefIsLess(r, kPrime32)) {
+    r = RefWrappingSub(r, kPrime32);
+  }
+  return r;
+}
+
+static Limbs32 RefSub(const Limbs32 &a, const Limbs32 &b) {
+  Limbs32 zero = {};
+  return (b == zero) ? a : RefAdd(a, RefWrappingSub(kPrime32, b));
+}
+
+static Limbs32 RefMul(const Limbs32 &a, const Limbs32 &b) {
+  Limbs32 r = {};
+  for (size_t i = 256; i-- > 0;) {
+    r = RefAdd(r, r);
+    if ((b[i / 32] >> (i % 32)) & 1) {
+      r = RefAdd(r, a);
+    }
+  }
+  return r;
+}
+
+static FieldElement RefReduce(const FieldElement &a) {
+  return FromLimbs32(RefReduce(ToLimbs32(a)));
+}
+
+static FieldElement RefAdd(const FieldElement &a, const FieldElement &b) {
+  return FromLimbs32(RefAdd(ToLimbs32(a), ToLimbs32(b)));
+}
+
+static FieldElement RefSub(const FieldElement &a, const FieldElement &b) {
+  return FromLimbs32(RefSub(ToLimbs32(a), ToLimbs32(b)));
+}
+
+static FieldElement RefMul(const FieldElement &a, const FieldElement &b) {
+  return FromLimbs32(
+    RefMul(RefReduce(ToLimbs32(a)), RefReduce(ToLimbs32(b))));
+}
+
+// a * b + c + carry as four 32 bit digits.
+static std::array<uint64_t, 4> RefMulAdd(
+  uint64_t a, uint64_t b, uint64_t c, uint64_t carry) {
+  std::array<uint64_t, 4> digits = {};
+  auto add_at = [&digits](size_t index, uint64_t value) {
+    for (; index < digits.size() && value != 0; index++) {
+      value += digits[index];
+      digits[index] = value & 0xffffffffULL;
+      value >>= 32;
+    }
+  };
+  uint64_t a_digits[2] = {a & 0xffffffffULL, a >> 32};
+  uint64_t b_digits[2] = {b & 0xffffffffULL, b >> 32};
+  for (size_t i = 0; i < 2; i++) {
+    for (size_t j = 0; j < 2; j++) {
+      uint64_t product = a_digits[i] * b_digits[j];
+      add_at(i + j, product & 0xffffffffULL);
+      add_at(i + j + 1, product >> 32);
+    }
+  }
+  add_at(0, c & 0xffffffffULL);
+  add_at(1, c >> 32);
+  add_at(0, carry & 0xffffffffULL);
+  add_at(1, carry >> 32);
+  return digits;
+}
+
+// p - value, for a small value.
+static FieldElement PrimeMinus(uint64_t value) {
+  auto r = kFieldPrime;
+  r[0] -= value;
+  return r;
+}
+
+static const uint64_t kAllOnes = 0xffffffffffffffffULL;
+
+// Elements on the reduction boundaries: around 0 and p, around 2^256 mod p
+// and with limbs made only of ones or zeros.
+static std::vector<FieldElement> GetBoundaryElements() {
+  return {
+    {{0, 0, 0, 0}},
+    {{1, 0, 0, 0}},
+    {{2, 0, 0, 0}},
+    {{0x1000003d0ULL, 0, 0, 0}},
+    {{0x1000003d1ULL, 0, 0, 0}},
+    {{0x1000003d2ULL, 0, 0, 0}},
+    {{kAllOnes, 0, 0, 0}},
+    {{0, 1, 0, 0}},
+    {{kAllOnes, kAllOnes, 0, 0}},
+    {{0, 0, 0, 0x8000000000000000ULL}},
+    {{0, kAllOnes, kAllOnes, kAllOnes}},
+    {{kAllOnes, kAllOnes, kAllOnes, 0x7fffffffffffffffULL}},
+    PrimeMinus(0x1000003d1ULL),
+    PrimeMinus(0xfffffffefffffc2fULL),
+    PrimeMinus(2),
+    PrimeMinus(1)};
+}
+
+// p + value, for a value lower than 2^256 - p.
+static FieldElement PrimePlus(uint64_t value) {
+  auto r = kFieldPrime;
+  r[0] += value;
+  return r;
+}
+
+// Values in [p, 2^256), which are only valid inputs of FieldMul and
+// FieldReduce.
+static std::vector<FieldElement> GetUnreducedElements() {
+  return {
+    kFieldPrime, PrimePlus(1), PrimePlus(0x100000000ULL),
+    PrimePlus(0x1000003cfULL), PrimePlus(0x1000003d0ULL)};
+}
+
+// Random elements whose limbs are often all ones, zero or equal to those of
+// p, so that the carries and reductions are exercised.
+static FieldElement GetRandomElement(std::mt19937_64 *rng) {
+  FieldElement r;
+  for (size_t i = 0; i < 4; i++) {
+    switch ((*rng)() % 5) {
+      case 0:
+        r[i] = kAllOnes;
+        break;
+      case 1:
+        r[i] = (*rng)() % 3;
+        break;
+      case 2:
+        r[i] = kFieldPrime[i] - (*rng)() % 3;
+        break;
+      default:
+        r[i] = (*rng)();
+        break;
+    }
+  }
+  return r;
+}
+
+static void ExpectFieldEq(const FieldElement &expected, const FieldElement &a) {
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_EQ(expected[i], a[i]) << "limb " << i;
+  }
+}
+
+TEST(FieldArithmetic, MulAddMatchesReference) {
+  std::vector<uint64_t> values = {
+    0, 1, 2, 0xffffffffULL, 0x100000000ULL, 0x8000000000000000ULL,
+    0x1000003d1ULL, 0xfffffffefffffc2fULL, kAllOnes - 1, kAllOnes};
+  std::mt19937_64 rng(1);
+  for (size_t i = 0; i < 20; i++) {
+    values.push_back(rng());
+  }
+
+  for (auto a : values) {
+    for (auto b : values) {
+      for (auto c : {static_cast<uint64_t>(0), kAllOnes, rng()}) {
+        for (auto carry : {static_cast<uint64_t>(0), kAllOnes, rng()}) {
+          auto digits = RefMulAdd(a, b, c, carry);
+          uint64_t expected_lo = digits[0] | (digits[1] << 32);
+          uint64_t expected_hi = digits[2] | (digits[3] << 32);
+
+          uint64_t hi = carry;
+          EXPECT_EQ(expected_lo, MulAddPortable(a, b, c, &hi));
+          EXPECT_EQ(expected_hi, hi);
+          hi = carry;
+          EXPECT_EQ(expected_lo, MulAdd(a, b, c, &hi));
+          EXPECT_EQ(expected_hi, hi);
+        }
+      }
+    }
+  }
+}
+
+TEST(FieldArithmetic, ReduceUnreducedValues) {
+  for (const auto &a : GetUnreducedElements()) {
+    auto reduced = a;
+    FieldReduce(&reduced);
+    ExpectFieldEq(RefReduce(a), reduced);
+  }
+  for (const auto &a : GetBoundaryElements()) {
+    auto reduced = a;
+    FieldReduce(&reduced);
+    ExpectFieldEq(a, reduced);
+  }
+}
+
+TEST(FieldArithmetic, BoundaryValues) {
+  auto elements = GetBoundaryElements();
+  for (const auto &a : elements) {
+    for (const auto &b : elements) {
+      ExpectFieldEq(RefAdd(a, b), FieldAdd(a, b));
+      ExpectFieldEq(RefSub(a, b), FieldSub(a, b));
+      ExpectFieldEq(RefMul(a, b), FieldMul(a, b));
+    }
+    ExpectFieldEq(RefMul(a, a), FieldSqr(a));
+  }
+
+  // products of values in [p, 2^256) are reduced as well.
+  auto unreduced = GetUnreducedElements();
+  elements.insert(elements.end(), unreduced.begin(), unreduced.end());
+  for (const auto &a : elements) {
+    for (const auto &b : unreduced) {
+      ExpectFieldEq(RefMul(a, b), FieldMul(a, b));
+      ExpectFieldEq(RefMul(a, b), FieldMul(b, a));
+    }
+  }
+}
+
+TEST(FieldArithmetic, Inverse) {
+  const FieldElement one = {{1, 0, 0, 0}};
+  for (const auto &a : GetBoundaryElements()) {
+    if (FieldIsZero(a)) {
+      EXPECT_TRUE(FieldIsZero(FieldInv(a)));
+      continue;
+    }
+    auto inverse = FieldInv(a);
+    ExpectFieldEq(one, FieldMul(a, inverse));
+    ExpectFieldEq(one, RefMul(a, inverse));
+  }
+}
+
+TEST(FieldArithmetic, RandomDifferential) {
+  std::mt19937_64 rng(2);
+  const FieldElement one = {{1, 0, 0, 0}};
+  for (size_t i = 0; i < 2000; i++) {
+    auto a = RefReduce(GetRandomElement(&rng));
+    auto b = RefReduce(GetRandomElement(&rng));
+    ExpectFieldEq(RefAdd(a, b), FieldAdd(a, b));
+    ExpectFieldEq(RefSub(a, b), FieldSub(a, b));
+    ExpectFieldEq(RefMul(a, b), FieldMul(a, b));
+    ExpectFieldEq(RefMul(a, a), FieldSqr(a));
+
+    auto unreduced = GetRandomElement(&rng);
+    ExpectFieldEq(RefMul(unreduced, b), FieldMul(unreduced, b));
+    if (i % 100 == 0 && !FieldIsZero(a)) {
+      ExpectFieldEq(one, RefMul(a, FieldInv(a)));
+    }
+  }
+}
+
+TEST(FieldArithmetic, BytesRoundTrip) {
+  std::mt19937_64 rng(3);
+  uint8_t bytes[32];
+  for (size_t i = 0; i < 100; i++) {
+    auto a = GetRandomElement(&rng);
+    FieldToBytes(a, bytes);
+    ExpectFieldEq(a, FieldFromBytes(bytes));
+  }
+  FieldToBytes(kFieldPrime, bytes);
+  EXPECT_EQ(0xff, bytes[0]);
+  EXPECT_EQ(0x2f, bytes[31]);
+}
@@ -0,0 +1,75 @@
+// Copyright 2020 CryptoGarage
+
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_hash.h"
+#include "gtest/gtest.h"
+
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+
+using cfd::dlc::BatchHashUtil;
+using cfd::dlc::Sha256Midstate;
+
+TEST(BatchHashUtil, MatchesHashUtil) {
+  // sizes around the padding boundaries, in no particular order, so that the
+  // messages of each size do not fill a whole group of lanes.
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t i = 0; i < 150; i++) {
+    size_t size = (i * 37) % 140;
+    std::vector<uint8_t> message(size);
+    for (size_t j = 0; j < size; j++) {
+      message[j] = static_cast<uint8_t>(i * 7 + j);
+    }
+    messages.push_back(message);
+  }
+
+  for (bool use_simd : {true, false}) {
+    auto hashes = BatchHashUtil::Sha256(messages, use_simd);
+    auto double_hashes = BatchHashUtil::Sha256D(messages, use_simd);
+    auto digests = BatchHashUtil::Sha256Digests(messages, use_simd);
+    ASSERT_EQ(messages.size(), hashes.size());
+    ASSERT_EQ(messages.size(), double_hashes.size());
+    ASSERT_EQ(messages.size() * 32, digests.size());
+    for (size_t i = 0; i < messages.size(); i++) {
+      EXPECT_EQ(HashUtil::Sha256(messages[i]).GetHex(), hashes[i].GetHex());
+      EXPECT_EQ(
+        hashes[i].GetBytes(),
+        std::vector<uint8_t>(
+          digests.begin() + 32 * i, digests.begin() + 32 * (i + 1)));
+      EXPECT_EQ(
+        HashUtil::Sha256D(messages[i]).GetHex(), double_hashes[i].GetHex());
+    }
+  }
+
+  EXPECT_TRUE(BatchHashUtil::Sha256D({}).empty());
+}
+
+TEST(Sha256Midstate, MatchesHashUtil) {
+  std::vector<uint8_t> prefix(128);
+  for (size_t i = 0; i < prefix.size(); i++) {
+    prefix[i] = static_cast<uint8_t>(i * 3);
+  }
+  Sha256Midstate midstate;
+  midstate.Write(std::vector<uint8_t>(prefix.begin(), prefix.begin() + 64));
+  midstate.Write(std::vector<uint8_t>(prefix.begin() + 64, prefix.end()));
+  EXPECT_EQ(static_cast<uint64_t>(128), midstate.GetLength());
+
+  for (size_t size = 0; size < 140; size++) {
+    std::vector<uint8_t> data(size);
+    for (size_t j = 0; j < size; j++) {
+      data[j] = static_cast<uint8_t>(size + j);
+    }
+    auto message = prefix;
+    message.insert(message.end(), data.begin(), data.end());
+    EXPECT_EQ(
+      HashUtil::Sha256(message).GetHex(), midstate.Finalize(data).GetHex());
+  }
+
+  EXPECT_EQ(
+    HashUtil::Sha256(std::vector<uint8_t>()).GetHex(),
+    Sha256Midstate().Finalize({}).GetHex());
+  EXPECT_THROW(midstate.Write(std::vector<uint8_t>(32)), CfdException);
+}
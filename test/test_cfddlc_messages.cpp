@@ -0,0 +1,188 @@
+// Copyright 2020 CryptoGarage
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_messages.h"
+#include "cfddlc/cfddlc_numeric.h"
+#include "cfddlc/cfddlc_transactions.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::Script;
+using cfd::Txid;
+using cfd::core::AdaptorPair;
+using cfd::core::ByteData256;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+
+using cfd::dlc::CetMessageBuffer;
+using cfd::dlc::CetSignatureHasher;
+using cfd::dlc::CetTemplate;
+using cfd::dlc::DlcManager;
+using cfd::dlc::DlcOutcome;
+using cfd::dlc::NumericOutcomeManager;
+using cfd::dlc::OracleNonceContext;
+using cfd::dlc::OraclePubkeyTable;
+
+const SchnorrPubkey ORACLE_PUBKEY = SchnorrPubkey::FromPrivkey(Privkey(
+  "ded9a76a0a77399e1c2676324118a0386004633f16245ad30d172b15c1f9e2d3"));
+const std::vector<SchnorrPubkey> ORACLE_R_VALUES = {
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "be3cc8de25c50e25f69e2f88d151e3f63e99c3a44fed2bdd2e3ee70fe141c5c3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "9e1bc6dc95ce931903cc2df67640cf6cca94ddd96aab0b847780d644e46cfae3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "6a43f3b7a3d1c2b4c2cc7a5fb6a3c3f0bd4e1ae5d3d2bd8e7cbb4a6a9b8e7d21"))};
+const Privkey LOCAL_FUND_PRIVKEY(
+  "0000000000000000000000000000000000000000000000000000000000000001");
+const Pubkey LOCAL_FUND_PUBKEY = LOCAL_FUND_PRIVKEY.GeneratePubkey();
+const Pubkey REMOTE_FUND_PUBKEY =
+  Privkey("0000000000000000000000000000000000000000000000000000000000000002")
+    .GeneratePubkey();
+const Amount TOTAL_COLLATERAL = Amount::CreateBySatoshiAmount(200000000);
+
+static void ExpectSameMessages(
+  const std::vector<std::vector<ByteData256>> &expected,
+  const CetMessageBuffer &buffer) {
+  ASSERT_EQ(expected.size(), buffer.GetCetCount());
+  for (size_t i = 0; i < expected.size(); i++) {
+    auto msgs = buffer.GetMessages(i);
+    ASSERT_EQ(expected[i].size(), msgs.size());
+    for (size_t j = 0; j < msgs.size(); j++) {
+      EXPECT_EQ(expected[i][j].GetHex(), msgs[j].GetHex());
+    }
+  }
+}
+
+TEST(CetMessageBuffer, FromOutcomes) {
+  std::vector<std::string> outcomes;
+  std::vector<std::vector<ByteData256>> expected;
+  for (size_t i = 0; i < 37; i++) {
+    outcomes.push_back("outcome " + std::to_string(i * 1000));
+    expected.push_back({HashUtil::Sha256(outcomes.back())});
+  }
+
+  ExpectSameMessages(expected, CetMessageBuffer::FromOutcomes(outcomes));
+  ExpectSameMessages(
+    expected, CetMessageBuffer::FromOutcomes(outcomes, false));
+  ExpectSameMessages(expected, CetMessageBuffer(expected));
+  EXPECT_EQ(
+    static_cast<size_t>(0), CetMessageBuffer::FromOutcomes({}).GetCetCount());
+}
+
+TEST(CetMessageBuffer, FromDigitPrefixes) {
+  std::vector<std::vector<uint32_t>> prefixes =
+    NumericOutcomeManager::ComputeCoveringPrefixes(17, 862, 10, 4);
+  auto expected = NumericOutcomeManager::GetPrefixMessages(
+    prefixes, NumericOutcomeManager::GetDigitMessages(10));
+  ExpectSameMessages(
+    expected, CetMessageBuffer::FromDigitPrefixes(10, 4, prefixes));
+
+  std::vector<ByteData256> digit_msgs = {
+    HashUtil::Sha256("zero"), HashUtil::Sha256("one")};
+  prefixes = {{0}, {1, 0}, {1, 1, 0, 1}};
+  expected = NumericOutcomeManager::GetPrefixMessages(prefixes, digit_msgs);
+  auto buffer = CetMessageBuffer::FromDigitPrefixes(2, 4, prefixes, digit_msgs);
+  ExpectSameMessages(expected, buffer);
+  EXPECT_EQ(static_cast<size_t>(4), buffer.GetMessageCount(2));
+  EXPECT_THROW(buffer.GetMessage(1, 2), CfdException);
+  EXPECT_THROW(buffer.GetMessageCount(3), CfdException);
+
+  EXPECT_THROW(
+    CetMessageBuffer::FromDigitPrefixes(2, 4, {std::vector<uint32_t>()}),
+    CfdException);
+  EXPECT_THROW(
+    CetMessageBuffer::FromDigitPrefixes(2, 2, {{0, 1, 0}}), CfdException);
+  EXPECT_THROW(
+    CetMessageBuffer::FromDigitPrefixes(2, 4, {{0, 2}}), CfdException);
+  EXPECT_THROW(
+    CetMessageBuffer::FromDigitPrefixes(3, 4, {{0}}, digit_msgs),
+    CfdException);
+}
+
+TEST(CetMessageBuffer, AdaptorSignaturesMatchNestedMessages) {
+  std::vector<std::vector<uint32_t>> prefixes =
+    NumericOutcomeManager::ComputeCoveringPrefixes(1, 6, 2, 3);
+  std::vector<DlcOutcome> outcomes;
+  for (size_t i = 0; i < prefixes.size(); i++) {
+    auto local_payout =
+      Amount::CreateBySatoshiAmount(static_cast<int64_t>(i) * 1000000);
+    outcomes.push_back({local_payout, TOTAL_COLLATERAL - local_payout});
+  }
+  auto msgs = NumericOutcomeManager::GetPrefixMessages(
+    prefixes, NumericOutcomeManager::GetDigitMessages(2));
+  auto buffer = CetMessageBuffer::FromDigitPrefixes(2, 3, prefixes);
+
+  CetSignatureHasher sig_hasher(
+    CetTemplate(
+      Txid("83266d6b22a9babf6ee469b88fd0d3a0c690525f7c903aff22ec8ee44214604f"),
+      0, Script("0014e8b9b1ab4c1cd3f76bcd8e5bdac28ef3e22e84b7"),
+      Script("0014c3a7d6e3b3e2a2e1f9e9b6d07c6a3cb0f3fd0b55")),
+    DlcManager::CreateFundTxLockingScript(
+      LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY),
+    TOTAL_COLLATERAL);
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    msgs);
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    buffer, 2);
+  ASSERT_EQ(expected.size(), adaptor_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      adaptor_pairs[i].signature.GetData().GetHex());
+  }
+
+  // adaptor points computed ahead of the payouts.
+  auto adaptor_points = DlcManager::ComputeAdaptorPoints(
+    buffer, OracleNonceContext(ORACLE_PUBKEY, ORACLE_R_VALUES));
+  auto precomputed_pairs = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_points, LOCAL_FUND_PRIVKEY, 2);
+  ASSERT_EQ(expected.size(), precomputed_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      precomputed_pairs[i].signature.GetData().GetHex());
+  }
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, precomputed_pairs, adaptor_points,
+    LOCAL_FUND_PUBKEY));
+  adaptor_points.pop_back();
+  EXPECT_THROW(
+    DlcManager::CreateCetAdaptorSignatures(
+      outcomes, sig_hasher, adaptor_points, LOCAL_FUND_PRIVKEY),
+    CfdException);
+
+  size_t invalid_index = 0;
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, LOCAL_FUND_PUBKEY,
+    ORACLE_PUBKEY, ORACLE_R_VALUES, 2, &invalid_index));
+  EXPECT_EQ(outcomes.size(), invalid_index);
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, LOCAL_FUND_PUBKEY,
+    OracleNonceContext(
+      std::make_shared<const OraclePubkeyTable>(ORACLE_PUBKEY),
+      ORACLE_R_VALUES)));
+  std::swap(adaptor_pairs[1], adaptor_pairs[2]);
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, buffer, LOCAL_FUND_PUBKEY,
+    ORACLE_PUBKEY, ORACLE_R_VALUES, 1, &invalid_index));
+  EXPECT_EQ(static_cast<size_t>(1), invalid_index);
+
+  outcomes.pop_back();
+  EXPECT_THROW(
+    DlcManager::CreateCetAdaptorSignatures(
+      outcomes, sig_hasher, ORACLE_PUBKEY, ORACLE_R_VALUES,
+      LOCAL_FUND_PRIVKEY, buffer),
+    CfdException);
+}
@@ -0,0 +1,214 @@
+// Copyright 2020 CryptoGarage
+
+#include <algorithm>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_numeric.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+
+using cfd::dlc::DlcOutcome;
+using cfd::dlc::NumericOutcomeManager;
+using cfd::dlc::PayoutInterval;
+using cfd::dlc::RoundingInterval;
+
+static DlcOutcome CreatePayout(int64_t local_payout) {
+  return {
+    Amount::CreateBySatoshiAmount(local_payout),
+    Amount::CreateBySatoshiAmount(100000000 - local_payout)};
+}
+
+static bool IsPrefixOf(
+  const std::vector<uint32_t> &prefix, const std::vector<uint32_t> &digits) {
+  return prefix.size() <= digits.size() &&
+         std::equal(prefix.begin(), prefix.end(), digits.begin());
+}
+
+TEST(NumericOutcomeManager, ComputeCoveringPrefixes) {
+  auto prefixes = NumericOutcomeManager::ComputeCoveringPrefixes(1, 14, 2, 4);
+  std::vector<std::vector<uint32_t>> expected = {
+    {0, 0, 0, 1}, {0, 0, 1}, {0, 1}, {1, 0}, {1, 1, 0}, {1, 1, 1, 0}};
+  EXPECT_EQ(expected, prefixes);
+
+  prefixes = NumericOutcomeManager::ComputeCoveringPrefixes(135, 677, 10, 3);
+  EXPECT_EQ(static_cast<size_t>(30), prefixes.size());
+  EXPECT_EQ(std::vector<uint32_t>({1, 3, 5}), prefixes.front());
+  EXPECT_EQ(std::vector<uint32_t>({2}), prefixes[11]);
+  EXPECT_EQ(std::vector<uint32_t>({6, 7, 7}), prefixes.back());
+
+  // a CET always needs at least one digit.
+  prefixes = NumericOutcomeManager::ComputeCoveringPrefixes(0, 7, 2, 3);
+  expected = {{0}, {1}};
+  EXPECT_EQ(expected, prefixes);
+
+  prefixes = NumericOutcomeManager::ComputeCoveringPrefixes(5, 5, 2, 3);
+  expected = {{1, 0, 1}};
+  EXPECT_EQ(expected, prefixes);
+
+  EXPECT_THROW(
+    NumericOutcomeManager::ComputeCoveringPrefixes(5, 4, 2, 3), CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::ComputeCoveringPrefixes(0, 8, 2, 3), CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::ComputeCoveringPrefixes(0, 1, 1, 3), CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::ComputeCoveringPrefixes(0, 1, 2, 65), CfdException);
+}
+
+TEST(NumericOutcomeManager, CreateNumericOutcomeCetsCoversEachOutcomeOnce) {
+  std::vector<PayoutInterval> intervals = {
+    {0, 99, CreatePayout(0)},
+    {100, 199, CreatePayout(0)},
+    {200, 299, CreatePayout(30000000)},
+    {300, 511, CreatePayout(100000000)},
+  };
+  auto cets =
+    NumericOutcomeManager::CreateNumericOutcomeCets(intervals, 2, 9);
+
+  ASSERT_EQ(cets.outcomes.size(), cets.digit_prefixes.size());
+  ASSERT_EQ(cets.outcomes.size(), cets.msgs.size());
+  EXPECT_LT(cets.outcomes.size(), static_cast<size_t>(20));
+
+  for (uint64_t outcome = 0; outcome < 512; outcome++) {
+    auto digits = NumericOutcomeManager::DecomposeOutcome(outcome, 2, 9);
+    size_t nb_matches = 0;
+    for (size_t i = 0; i < cets.digit_prefixes.size(); i++) {
+      if (!IsPrefixOf(cets.digit_prefixes[i], digits)) {
+        continue;
+      }
+      nb_matches++;
+      int64_t expected = (outcome < 200)   ? 0
+                         : (outcome < 300) ? 30000000
+                                           : 100000000;
+      EXPECT_EQ(expected, cets.outcomes[i].local_payout.GetSatoshiValue());
+    }
+    EXPECT_EQ(static_cast<size_t>(1), nb_matches);
+  }
+
+  auto digit_msgs = NumericOutcomeManager::GetDigitMessages(2);
+  for (size_t i = 0; i < cets.msgs.size(); i++) {
+    ASSERT_EQ(cets.digit_prefixes[i].size(), cets.msgs[i].size());
+    for (size_t j = 0; j < cets.msgs[i].size(); j++) {
+      EXPECT_EQ(
+        digit_msgs[cets.digit_prefixes[i][j]].GetHex(),
+        cets.msgs[i][j].GetHex());
+    }
+  }
+  EXPECT_EQ(HashUtil::Sha256("1").GetHex(), digit_msgs[1].GetHex());
+}
+
+TEST(NumericOutcomeManager, CreateNumericOutcomeCetsInvalidIntervals) {
+  // not covering all the outcomes.
+  EXPECT_THROW(
+    NumericOutcomeManager::CreateNumericOutcomeCets(
+      {{0, 6, CreatePayout(0)}}, 2, 3),
+    CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::CreateNumericOutcomeCets(
+      {{1, 7, CreatePayout(0)}}, 2, 3),
+    CfdException);
+  // gap and overlap.
+  EXPECT_THROW(
+    NumericOutcomeManager::CreateNumericOutcomeCets(
+      {{0, 2, CreatePayout(0)}, {4, 7, CreatePayout(1)}}, 2, 3),
+    CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::CreateNumericOutcomeCets(
+      {{0, 4, CreatePayout(0)}, {4, 7, CreatePayout(1)}}, 2, 3),
+    CfdException);
+  // digit messages not matching the base.
+  EXPECT_THROW(
+    NumericOutcomeManager::CreateNumericOutcomeCets(
+      {{0, 7, CreatePayout(0)}}, 2, 3,
+      NumericOutcomeManager::GetDigitMessages(3)),
+    CfdException);
+}
+
+TEST(NumericOutcomeManager, RoundPayoutIntervals) {
+  // one interval per outcome, the payout growing by 1100 sats per outcome.
+  std::vector<PayoutInterval> intervals;
+  for (uint64_t i = 0; i < 16; i++) {
+    intervals.push_back({i, i, CreatePayout(static_cast<int64_t>(i * 1100))});
+  }
+  std::vector<RoundingInterval> rounding_intervals = {{0, 5000}, {12, 1}};
+
+  auto rounded =
+    NumericOutcomeManager::RoundPayoutIntervals(intervals, rounding_intervals);
+
+  // 0-2 -> 0, 3-6 -> 5000, 7-11 -> 10000, then no rounding.
+  ASSERT_EQ(static_cast<size_t>(7), rounded.size());
+  std::vector<uint64_t> expected_starts = {0, 3, 7, 12, 13, 14, 15};
+  std::vector<int64_t> expected_payouts = {
+    0, 5000, 10000, 13200, 14300, 15400, 16500};
+  for (size_t i = 0; i < rounded.size(); i++) {
+    EXPECT_EQ(expected_starts[i], rounded[i].start);
+    EXPECT_EQ(
+      expected_payouts[i], rounded[i].payout.local_payout.GetSatoshiValue());
+    EXPECT_EQ(
+      100000000,
+      (rounded[i].payout.local_payout + rounded[i].payout.remote_payout)
+        .GetSatoshiValue());
+  }
+  EXPECT_EQ(static_cast<uint64_t>(15), rounded.back().end);
+
+  // a single interval crossing a rounding boundary is split, and payouts are
+  // clamped to the total collateral.
+  rounded = NumericOutcomeManager::RoundPayoutIntervals(
+    {{0, 15, CreatePayout(99999999)}}, {{0, 1}, {8, 1000}});
+  ASSERT_EQ(static_cast<size_t>(2), rounded.size());
+  EXPECT_EQ(static_cast<uint64_t>(7), rounded[0].end);
+  EXPECT_EQ(99999999, rounded[0].payout.local_payout.GetSatoshiValue());
+  EXPECT_EQ(100000000, rounded[1].payout.local_payout.GetSatoshiValue());
+  EXPECT_EQ(0, rounded[1].payout.remote_payout.GetSatoshiValue());
+
+  EXPECT_THROW(
+    NumericOutcomeManager::RoundPayoutIntervals(intervals, {{1, 10}}),
+    CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::RoundPayoutIntervals(intervals, {{0, 0}}),
+    CfdException);
+  EXPECT_THROW(
+    NumericOutcomeManager::RoundPayoutIntervals(
+      intervals, {{0, 10}, {5, 10}, {5, 10}}),
+    CfdException);
+}
+
+TEST(NumericOutcomeManager, CreateNumericOutcomeCetsWithRounding) {
+  std::vector<PayoutInterval> intervals;
+  for (uint64_t i = 0; i < 256; i++) {
+    intervals.push_back({i, i, CreatePayout(static_cast<int64_t>(i * 7))});
+  }
+
+  int64_t nb_removed_cets = 0;
+  auto cets = NumericOutcomeManager::CreateNumericOutcomeCets(
+    intervals, {{0, 100}}, 2, 8, &nb_removed_cets);
+  auto unrounded_cets =
+    NumericOutcomeManager::CreateNumericOutcomeCets(intervals, 2, 8);
+
+  EXPECT_EQ(static_cast<size_t>(256), unrounded_cets.outcomes.size());
+  EXPECT_EQ(static_cast<size_t>(65), cets.outcomes.size());
+  EXPECT_EQ(191, nb_removed_cets);
+  for (const auto &outcome : cets.outcomes) {
+    EXPECT_EQ(0, outcome.local_payout.GetSatoshiValue() % 100);
+  }
+}
+
+TEST(NumericOutcomeManager, CreateNumericOutcomeCetsWithRoundingAddingCets) {
+  // a flat payout is covered by 10 CETs, but rounding it differently below
+  // and above outcome 5 splits it, needing 5 + 23 CETs.
+  int64_t nb_removed_cets = 0;
+  auto cets = NumericOutcomeManager::CreateNumericOutcomeCets(
+    {{0, 999, CreatePayout(55)}}, {{0, 10}, {5, 100}}, 10, 3,
+    &nb_removed_cets);
+
+  EXPECT_EQ(static_cast<size_t>(28), cets.outcomes.size());
+  EXPECT_EQ(-18, nb_removed_cets);
+  EXPECT_EQ(60, cets.outcomes.front().local_payout.GetSatoshiValue());
+  EXPECT_EQ(100, cets.outcomes.back().local_payout.GetSatoshiValue());
+}
@@ -0,0 +1,325 @@
+// Copyright 2020 CryptoGarage
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cfd/cfd_transaction.h"
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_ecdsa_adaptor.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfddlc/cfddlc_oracle.h"
+#include "cfddlc/cfddlc_transactions.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::TransactionController;
+using cfd::core::AdaptorPair;
+using cfd::core::Address;
+using cfd::core::ByteData256;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::NetType;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+using cfd::core::SchnorrUtil;
+using cfd::core::Txid;
+using cfd::core::TxOut;
+using cfd::core::WitnessVersion;
+
+using cfd::dlc::DlcManager;
+using cfd::dlc::OracleEventPointTable;
+using cfd::dlc::OracleNonceContext;
+using cfd::dlc::OraclePubkeyTable;
+
+const Privkey ORACLE_PRIVKEY(
+  "ded9a76a0a77399e1c2676324118a0386004633f16245ad30d172b15c1f9e2d3");
+const SchnorrPubkey ORACLE_PUBKEY = SchnorrPubkey::FromPrivkey(ORACLE_PRIVKEY);
+const std::vector<SchnorrPubkey> ORACLE_R_POINTS = {
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "be3cc8de25c50e25f69e2f88d151e3f63e99c3a44fed2bdd2e3ee70fe141c5c3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "9e1bc6dc95ce931903cc2df67640cf6cca94ddd96aab0b847780d644e46cfae3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "6a43f3b7a3d1c2b4c2cc7a5fb6a3c3f0bd4e1ae5d3d2bd8e7cbb4a6a9b8e7d21")),
+};
+const std::vector<ByteData256> DIGIT_MSGS = {
+  HashUtil::Sha256("0"), HashUtil::Sha256("1")};
+const Privkey LOCAL_FUND_PRIVKEY(
+  "0000000000000000000000000000000000000000000000000000000000000001");
+const Pubkey LOCAL_FUND_PUBKEY = LOCAL_FUND_PRIVKEY.GeneratePubkey();
+const Pubkey REMOTE_FUND_PUBKEY =
+  Privkey("0000000000000000000000000000000000000000000000000000000000000002")
+    .GeneratePubkey();
+const Amount FUND_OUTPUT = Amount::CreateBySatoshiAmount(200000170);
+const Txid FUND_TX_ID(
+  "83266d6b22a9babf6ee469b88fd0d3a0c690525f7c903aff22ec8ee44214604f");
+const Address LOCAL_FINAL_ADDRESS(
+  NetType::kRegtest, WitnessVersion::kVersion0,
+  Privkey("0000000000000000000000000000000000000000000000000000000000000007")
+    .GeneratePubkey());
+const Address REMOTE_FINAL_ADDRESS(
+  NetType::kRegtest, WitnessVersion::kVersion0,
+  Privkey("0000000000000000000000000000000000000000000000000000000000000008")
+    .GeneratePubkey());
+
+// Every outcome of a three digit base 2 event.
+static std::vector<std::vector<ByteData256>> CreateDigitMessages() {
+  std::vector<std::vector<ByteData256>> msgs;
+  for (size_t i = 0; i < 8; i++) {
+    msgs.push_back(
+      {DIGIT_MSGS[(i >> 2) & 1], DIGIT_MSGS[(i >> 1) & 1], DIGIT_MSGS[i & 1]});
+  }
+  return msgs;
+}
+
+static std::vector<TransactionController> CreateCets(size_t nb) {
+  std::vector<TransactionController> cets;
+  for (size_t i = 0; i < nb; i++) {
+    auto local_amount = Amount::CreateBySatoshiAmount(
+      static_cast<int64_t>(100000 + i * 10000));
+    cets.push_back(DlcManager::CreateCet(
+      TxOut(local_amount, LOCAL_FINAL_ADDRESS),
+      TxOut(
+        Amount::CreateBySatoshiAmount(200000000) - local_amount,
+        REMOTE_FINAL_ADDRESS),
+      FUND_TX_ID, 0));
+  }
+  return cets;
+}
+
+TEST(OracleNonceContext, SigPointsMatchSchnorrUtil) {
+  OracleNonceContext context(ORACLE_PUBKEY, ORACLE_R_POINTS);
+
+  EXPECT_EQ(ORACLE_R_POINTS.size(), context.GetNonceCount());
+  for (size_t i = 0; i < ORACLE_R_POINTS.size(); i++) {
+    for (size_t j = 0; j < 20; j++) {
+      auto msg = HashUtil::Sha256(std::to_string(j));
+      auto expected =
+        SchnorrUtil::ComputeSigPoint(msg, ORACLE_R_POINTS[i], ORACLE_PUBKEY);
+      EXPECT_EQ(expected.GetHex(), context.ComputeSigPoint(i, msg).GetHex());
+    }
+  }
+  EXPECT_THROW(context.ComputeSigPoint(3, DIGIT_MSGS[0]), CfdException);
+}
+
+TEST(OracleNonceContext, ComputeAdaptorPointMatchesSigPointSum) {
+  OracleNonceContext context(ORACLE_PUBKEY, ORACLE_R_POINTS);
+
+  for (const auto &msgs : CreateDigitMessages()) {
+    std::vector<Pubkey> sig_points;
+    for (size_t i = 0; i < msgs.size(); i++) {
+      sig_points.push_back(SchnorrUtil::ComputeSigPoint(
+        msgs[i], ORACLE_R_POINTS[i], ORACLE_PUBKEY));
+    }
+    auto expected = Pubkey::CombinePubkey(sig_points);
+    EXPECT_EQ(expected.GetHex(), context.ComputeAdaptorPoint(msgs).GetHex());
+    EXPECT_EQ(
+      expected.GetHex(),
+      DlcManager::ComputeAdaptorPoint(msgs, ORACLE_R_POINTS, ORACLE_PUBKEY)
+        .GetHex());
+  }
+
+  auto msgs = CreateDigitMessages();
+  auto adaptor_points = DlcManager::ComputeAdaptorPoints(msgs, context);
+  ASSERT_EQ(msgs.size(), adaptor_points.size());
+  for (size_t i = 0; i < msgs.size(); i++) {
+    EXPECT_EQ(
+      context.ComputeAdaptorPoint(msgs[i]).GetHex(),
+      adaptor_points[i].GetHex());
+  }
+
+  EXPECT_THROW(
+    context.ComputeAdaptorPoint(std::vector<ByteData256>()), CfdException);
+  EXPECT_THROW(
+    context.ComputeAdaptorPoint(
+      {DIGIT_MSGS[0], DIGIT_MSGS[0], DIGIT_MSGS[0], DIGIT_MSGS[0]}),
+    CfdException);
+}
+
+TEST(OraclePubkeyTable, MultiplyMatchesTweakMul) {
+  OraclePubkeyTable table(ORACLE_PUBKEY);
+  Pubkey oracle_point(std::string("02") + ORACLE_PUBKEY.GetHex());
+
+  EXPECT_EQ(ORACLE_PUBKEY.GetHex(), table.GetOraclePubkey().GetHex());
+  std::vector<ByteData256> scalars = {
+    ByteData256(
+      "0000000000000000000000000000000000000000000000000000000000000001"),
+    ByteData256(
+      "00000000000000000000000000000000000000000000000000000000000000f0"),
+    ByteData256(
+      "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140")};
+  for (size_t i = 0; i < 20; i++) {
+    scalars.push_back(HashUtil::Sha256(std::to_string(i)));
+  }
+  for (const auto &scalar : scalars) {
+    EXPECT_EQ(
+      oracle_point.CreateTweakMul(scalar).GetHex(),
+      table.Multiply(scalar).GetHex());
+  }
+  EXPECT_THROW(table.Multiply(ByteData256()), CfdException);
+}
+
+TEST(OraclePubkeyTable, NonceContextMatchesWithoutTable) {
+  auto pubkey_table = std::make_shared<const OraclePubkeyTable>(ORACLE_PUBKEY);
+  OracleNonceContext expected(ORACLE_PUBKEY, ORACLE_R_POINTS);
+  OracleNonceContext context(pubkey_table, ORACLE_R_POINTS);
+
+  EXPECT_EQ(ORACLE_PUBKEY.GetHex(), context.GetOraclePubkey().GetHex());
+  for (size_t i = 0; i < ORACLE_R_POINTS.size(); i++) {
+    EXPECT_EQ(
+      expected.ComputeSigPoint(i, DIGIT_MSGS[1]).GetHex(),
+      context.ComputeSigPoint(i, DIGIT_MSGS[1]).GetHex());
+  }
+  for (const auto &msgs : CreateDigitMessages()) {
+    EXPECT_EQ(
+      expected.ComputeAdaptorPoint(msgs).GetHex(),
+      context.ComputeAdaptorPoint(msgs).GetHex());
+  }
+
+  OracleEventPointTable table(context, DIGIT_MSGS);
+  OracleEventPointTable expected_table(
+    ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+  for (size_t i = 0; i < ORACLE_R_POINTS.size(); i++) {
+    for (size_t j = 0; j < DIGIT_MSGS.size(); j++) {
+      EXPECT_EQ(
+        expected_table.GetSigPoint(i, j).GetHex(),
+        table.GetSigPoint(i, j).GetHex());
+    }
+  }
+}
+
+TEST(OraclePubkeyTable, VerifyCetAdaptorSignatures) {
+  // enough CETs for the verification to build a pubkey table.
+  std::vector<std::vector<ByteData256>> msgs;
+  for (size_t i = 0; i < 40; i++) {
+    msgs.push_back({HashUtil::Sha256("outcome " + std::to_string(i))});
+  }
+  auto cets = CreateCets(msgs.size());
+  auto fund_script = DlcManager::CreateFundTxLockingScript(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY);
+  auto sigs = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_POINTS, LOCAL_FUND_PRIVKEY, fund_script,
+    FUND_OUTPUT, msgs);
+
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, sigs, msgs, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY, ORACLE_R_POINTS,
+    fund_script, FUND_OUTPUT));
+  auto context = DlcManager::CreateVerificationNonceContext(
+    ORACLE_PUBKEY, ORACLE_R_POINTS, msgs.size());
+  for (size_t i = 0; i < 3; i++) {
+    EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignature(
+      sigs[i], cets[i], LOCAL_FUND_PUBKEY, context, fund_script, FUND_OUTPUT,
+      msgs[i]));
+  }
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignature(
+    sigs[0], cets[0], LOCAL_FUND_PUBKEY, context, fund_script, FUND_OUTPUT,
+    msgs[1]));
+
+  std::swap(sigs[35], sigs[36]);
+  size_t invalid_index = 0;
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, sigs, msgs, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY, ORACLE_R_POINTS,
+    fund_script, FUND_OUTPUT, 2, &invalid_index));
+  EXPECT_EQ(static_cast<size_t>(35), invalid_index);
+}
+
+TEST(OracleEventPointTable, SigPointsMatchSchnorrUtil) {
+  OracleEventPointTable table(ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+
+  EXPECT_EQ(ORACLE_R_POINTS.size(), table.GetNonceCount());
+  EXPECT_EQ(DIGIT_MSGS.size(), table.GetDigitCount());
+  for (size_t i = 0; i < ORACLE_R_POINTS.size(); i++) {
+    for (size_t j = 0; j < DIGIT_MSGS.size(); j++) {
+      auto expected = SchnorrUtil::ComputeSigPoint(
+        DIGIT_MSGS[j], ORACLE_R_POINTS[i], ORACLE_PUBKEY);
+      EXPECT_EQ(expected.GetHex(), table.GetSigPoint(i, j).GetHex());
+    }
+  }
+  EXPECT_EQ(static_cast<size_t>(1), table.GetDigitIndex(DIGIT_MSGS[1]));
+  EXPECT_THROW(table.GetSigPoint(3, 0), CfdException);
+  EXPECT_THROW(table.GetSigPoint(0, 2), CfdException);
+}
+
+TEST(OracleEventPointTable, ComputeAdaptorPointMatchesDlcManager) {
+  OracleEventPointTable table(ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+
+  for (const auto &msgs : CreateDigitMessages()) {
+    auto expected =
+      DlcManager::ComputeAdaptorPoint(msgs, ORACLE_R_POINTS, ORACLE_PUBKEY);
+    EXPECT_EQ(expected.GetHex(), table.ComputeAdaptorPoint(msgs).GetHex());
+  }
+
+  // Prefixes of an outcome only use the first nonces.
+  std::vector<ByteData256> prefix = {DIGIT_MSGS[1], DIGIT_MSGS[0]};
+  auto expected = DlcManager::ComputeAdaptorPoint(
+    prefix, {ORACLE_R_POINTS[0], ORACLE_R_POINTS[1]}, ORACLE_PUBKEY);
+  EXPECT_EQ(expected.GetHex(), table.ComputeAdaptorPoint(prefix).GetHex());
+  EXPECT_EQ(
+    expected.GetHex(),
+    table.ComputeAdaptorPoint(std::vector<size_t>{1, 0}).GetHex());
+}
+
+TEST(OracleEventPointTable, InvalidInputsFail) {
+  EXPECT_THROW(
+    OracleEventPointTable(ORACLE_PUBKEY, {}, DIGIT_MSGS), CfdException);
+  EXPECT_THROW(
+    OracleEventPointTable(ORACLE_PUBKEY, ORACLE_R_POINTS, {}), CfdException);
+
+  OracleEventPointTable table(ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+  EXPECT_THROW(
+    table.ComputeAdaptorPoint({HashUtil::Sha256("2")}), CfdException);
+  EXPECT_THROW(
+    table.ComputeAdaptorPoint(std::vector<ByteData256>()), CfdException);
+  EXPECT_THROW(
+    table.ComputeAdaptorPoint(
+      {DIGIT_MSGS[0], DIGIT_MSGS[0], DIGIT_MSGS[0], DIGIT_MSGS[0]}),
+    CfdException);
+}
+
+TEST(OracleEventPointTable, AdaptorSigMatchesRValues) {
+  OracleEventPointTable table(ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+  auto msgs = CreateDigitMessages();
+  auto cets = CreateCets(msgs.size());
+  auto fund_script = DlcManager::CreateFundTxLockingScript(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY);
+
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_POINTS, LOCAL_FUND_PRIVKEY, fund_script,
+    FUND_OUTPUT, msgs);
+  auto sigs = DlcManager::CreateCetAdaptorSignatures(
+    cets, table, LOCAL_FUND_PRIVKEY, fund_script, FUND_OUTPUT, msgs, 2);
+
+  ASSERT_EQ(expected.size(), sigs.size());
+  for (size_t i = 0; i < sigs.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      sigs[i].signature.GetData().GetHex());
+    EXPECT_EQ(
+      expected[i].proof.GetData().GetHex(), sigs[i].proof.GetData().GetHex());
+    EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignature(
+      sigs[i], cets[i], LOCAL_FUND_PUBKEY, table, fund_script, FUND_OUTPUT,
+      msgs[i]));
+  }
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, sigs, msgs, LOCAL_FUND_PUBKEY, table, fund_script, FUND_OUTPUT));
+}
+
+TEST(OracleEventPointTable, AdaptorSigVerifyReportsFirstInvalidIndex) {
+  OracleEventPointTable table(ORACLE_PUBKEY, ORACLE_R_POINTS, DIGIT_MSGS);
+  auto msgs = CreateDigitMessages();
+  auto cets = CreateCets(msgs.size());
+  auto fund_script = DlcManager::CreateFundTxLockingScript(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY);
+  auto sigs = DlcManager::CreateCetAdaptorSignatures(
+    cets, table, LOCAL_FUND_PRIVKEY, fund_script, FUND_OUTPUT, msgs);
+  std::swap(sigs[3], sigs[6]);
+
+  size_t invalid_index = 0;
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, sigs, msgs, LOCAL_FUND_PUBKEY, table, fund_script, FUND_OUTPUT, 4,
+    &invalid_index));
+  EXPECT_EQ(static_cast<size_t>(3), invalid_index);
+}
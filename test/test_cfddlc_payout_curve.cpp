@@ -0,0 +1,123 @@
+// Copyright 2020 CryptoGarage
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfddlc/cfddlc_payout_curve.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::core::CfdException;
+
+using cfd::dlc::kPayoutHyperbola;
+using cfd::dlc::kPayoutPolynomial;
+using cfd::dlc::NumericOutcomeManager;
+using cfd::dlc::PayoutCurve;
+using cfd::dlc::PayoutCurvePiece;
+
+const Amount TOTAL_COLLATERAL = Amount::CreateBySatoshiAmount(100000000);
+
+TEST(PayoutCurve, LinearPieces) {
+  // 0 below 1000, then linear up to the total collateral at 3000.
+  PayoutCurve curve(
+    {PayoutCurve::CreateLinearPiece(0, 0, 999, 0),
+     PayoutCurve::CreateLinearPiece(1000, 0, 3000, 100000000),
+     PayoutCurve::CreateLinearPiece(3001, 100000000, 4095, 100000000)});
+  EXPECT_EQ(static_cast<uint64_t>(0), curve.GetStart());
+  EXPECT_EQ(static_cast<uint64_t>(4095), curve.GetEnd());
+
+  auto outcomes = curve.ComputeOutcomes(TOTAL_COLLATERAL);
+  ASSERT_EQ(static_cast<size_t>(4096), outcomes.size());
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    int64_t expected = 0;
+    if (i >= 3000) {
+      expected = 100000000;
+    } else if (i >= 1000) {
+      expected = static_cast<int64_t>(i - 1000) * 50000;
+    }
+    EXPECT_EQ(expected, outcomes[i].local_payout.GetSatoshiValue());
+    EXPECT_EQ(
+      TOTAL_COLLATERAL,
+      outcomes[i].local_payout + outcomes[i].remote_payout);
+  }
+
+  auto intervals = curve.ComputePayoutIntervals(TOTAL_COLLATERAL);
+  ASSERT_EQ(static_cast<size_t>(2001), intervals.size());
+  EXPECT_EQ(static_cast<uint64_t>(1000), intervals.front().end);
+  EXPECT_EQ(static_cast<uint64_t>(3000), intervals.back().start);
+  EXPECT_EQ(static_cast<uint64_t>(4095), intervals.back().end);
+  auto cets =
+    NumericOutcomeManager::CreateNumericOutcomeCets(intervals, 2, 12);
+  EXPECT_LT(cets.outcomes.size(), static_cast<size_t>(2100));
+}
+
+TEST(PayoutCurve, PolynomialAndHyperbolaPieces) {
+  PayoutCurvePiece polynomial = {
+    kPayoutPolynomial, 0, 999, {1000.0, 0.5, 0.25}};
+  PayoutCurvePiece hyperbola = {
+    kPayoutHyperbola, 1000, 1999, {-1000.0, 1.5e11, 0.0}};
+  PayoutCurve curve({polynomial, hyperbola});
+
+  std::vector<int64_t> payouts(2000);
+  curve.ComputeLocalPayouts(0, 1999, TOTAL_COLLATERAL, payouts.data());
+  for (size_t i = 0; i < 1000; i++) {
+    double x = static_cast<double>(i);
+    auto expected =
+      static_cast<int64_t>(std::floor(1000.0 + 0.5 * x + 0.25 * x * x + 0.5));
+    EXPECT_EQ(expected, payouts[i]);
+  }
+  // clamped to the total collateral at the beginning of the hyperbola.
+  EXPECT_EQ(100000000, payouts[1000]);
+  for (size_t i = 1000; i < 2000; i++) {
+    double x = static_cast<double>(i);
+    auto expected =
+      static_cast<int64_t>(std::floor(-1000.0 + 1.5e11 / x + 0.5));
+    EXPECT_EQ(std::min<int64_t>(expected, 100000000), payouts[i]);
+  }
+  EXPECT_LT(payouts[1999], 100000000);
+
+  // sub ranges give the same values as the whole range.
+  std::vector<int64_t> sub_payouts(700);
+  curve.ComputeLocalPayouts(900, 1599, TOTAL_COLLATERAL, sub_payouts.data());
+  for (size_t i = 0; i < sub_payouts.size(); i++) {
+    EXPECT_EQ(payouts[900 + i], sub_payouts[i]);
+  }
+
+  // negative payouts are clamped to 0.
+  PayoutCurve negative({PayoutCurve::CreateLinearPiece(0, -5000, 10, 5000)});
+  auto outcomes = negative.ComputeOutcomes(TOTAL_COLLATERAL);
+  EXPECT_EQ(0, outcomes[0].local_payout.GetSatoshiValue());
+  EXPECT_EQ(0, outcomes[5].local_payout.GetSatoshiValue());
+  EXPECT_EQ(5000, outcomes[10].local_payout.GetSatoshiValue());
+}
+
+TEST(PayoutCurve, InvalidPieces) {
+  EXPECT_THROW(PayoutCurve({}), CfdException);
+  EXPECT_THROW(
+    PayoutCurve(
+      {PayoutCurve::CreateLinearPiece(0, 0, 10, 0),
+       PayoutCurve::CreateLinearPiece(12, 0, 20, 0)}),
+    CfdException);
+  EXPECT_THROW(
+    PayoutCurve({PayoutCurve::CreateLinearPiece(10, 0, 5, 0)}), CfdException);
+  EXPECT_THROW(
+    PayoutCurve({{kPayoutPolynomial, 0, 10, {}}}), CfdException);
+  EXPECT_THROW(
+    PayoutCurve({{kPayoutHyperbola, 0, 10, {1.0, 2.0}}}), CfdException);
+  EXPECT_THROW(
+    PayoutCurve({{kPayoutHyperbola, 0, 10, {1.0, 2.0, 5.0}}}), CfdException);
+  EXPECT_THROW(
+    PayoutCurve({{kPayoutPolynomial, 0, 10, {NAN}}}), CfdException);
+
+  PayoutCurve curve({PayoutCurve::CreateLinearPiece(5, 0, 10, 0)});
+  std::vector<int64_t> payouts(20);
+  EXPECT_THROW(
+    curve.ComputeLocalPayouts(4, 10, TOTAL_COLLATERAL, payouts.data()),
+    CfdException);
+  EXPECT_THROW(
+    curve.ComputeLocalPayouts(5, 11, TOTAL_COLLATERAL, payouts.data()),
+    CfdException);
+}
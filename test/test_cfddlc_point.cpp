@@ -0,0 +1,134 @@
+// Copyright 2020 CryptoGarage
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_key.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_point.h"
+#include "gtest/gtest.h"
+
+using cfd::core::ByteData256;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+
+using cfd::dlc::JacobianPoint;
+
+static std::vector<Pubkey> CreatePubkeys(size_t nb) {
+  std::vector<Pubkey> pubkeys;
+  for (size_t i = 0; i < nb; i++) {
+    pubkeys.push_back(
+      Privkey(HashUtil::Sha256(std::to_string(i))).GeneratePubkey());
+  }
+  return pubkeys;
+}
+
+TEST(JacobianPoint, SumsMatchCombinePubkey) {
+  auto pubkeys = CreatePubkeys(10);
+
+  JacobianPoint first(pubkeys[0]);
+  auto doubled_first = first.Add(first);
+  auto expected_doubled = Pubkey::CombinePubkey(pubkeys[0], pubkeys[0]);
+  std::vector<JacobianPoint> sums;
+  std::vector<Pubkey> expected;
+  JacobianPoint sum;
+  Pubkey expected_sum = pubkeys[0];
+  for (size_t i = 0; i < pubkeys.size(); i++) {
+    sum = sum.Add(JacobianPoint(pubkeys[i]));
+    if (i != 0) {
+      expected_sum = Pubkey::CombinePubkey(expected_sum, pubkeys[i]);
+    }
+    sums.push_back(sum);
+    expected.push_back(expected_sum);
+    // sums of sums have no affine operand.
+    sums.push_back(sum.Add(doubled_first));
+    expected.push_back(Pubkey::CombinePubkey(expected_sum, expected_doubled));
+  }
+
+  auto converted = JacobianPoint::ToPubkeys(sums);
+  ASSERT_EQ(expected.size(), converted.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].GetHex(), converted[i].GetHex());
+    EXPECT_EQ(expected[i].GetHex(), sums[i].ToPubkey().GetHex());
+  }
+
+  auto uncompressed = JacobianPoint::ToPubkeys(sums, false);
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      JacobianPoint(uncompressed[i]).ToPubkey().GetHex(),
+      converted[i].GetHex());
+    EXPECT_EQ(static_cast<size_t>(65), uncompressed[i].GetData().GetDataSize());
+  }
+}
+
+TEST(JacobianPoint, DoublingAndInfinity) {
+  auto pubkey = CreatePubkeys(1)[0];
+  JacobianPoint point(pubkey);
+
+  auto doubled = point.Add(point);
+  auto expected = Pubkey::CombinePubkey(pubkey, pubkey);
+  EXPECT_EQ(expected.GetHex(), doubled.ToPubkey().GetHex());
+  EXPECT_EQ(
+    Pubkey::CombinePubkey(expected, expected).GetHex(),
+    doubled.Add(doubled).ToPubkey().GetHex());
+
+  auto infinity = point.Add(JacobianPoint(pubkey.CreateNegate()));
+  EXPECT_TRUE(infinity.IsInfinity());
+  EXPECT_TRUE(JacobianPoint().IsInfinity());
+  EXPECT_EQ(pubkey.GetHex(), infinity.Add(point).ToPubkey().GetHex());
+  EXPECT_THROW(infinity.ToPubkey(), CfdException);
+  EXPECT_THROW(JacobianPoint::ToPubkeys({point, infinity}), CfdException);
+  EXPECT_TRUE(JacobianPoint::ToPubkeys({}).empty());
+}
+
+TEST(JacobianPoint, RandomOperationsMatchCombinePubkey) {
+  auto pubkeys = CreatePubkeys(32);
+  std::mt19937 rng(4);
+  // two running sums, so that both operands of an addition can be Jacobian.
+  JacobianPoint sums[2] = {
+    JacobianPoint(pubkeys[0]), JacobianPoint(pubkeys[1])};
+  Pubkey expected_sums[2] = {pubkeys[0], pubkeys[1]};
+  std::vector<JacobianPoint> points;
+  std::vector<Pubkey> expected;
+  for (size_t i = 0; i < 3000; i++) {
+    size_t index = rng() % 2;
+    auto &sum = sums[index];
+    auto &expected_sum = expected_sums[index];
+    const auto &pubkey = pubkeys[rng() % pubkeys.size()];
+    switch (rng() % 4) {
+      case 0:
+        // mixed addition.
+        sum = sum.Add(JacobianPoint(pubkey));
+        expected_sum = Pubkey::CombinePubkey(expected_sum, pubkey);
+        break;
+      case 1:
+        // mixed addition, the affine point being first.
+        sum = JacobianPoint(pubkey).Add(sum);
+        expected_sum = Pubkey::CombinePubkey(pubkey, expected_sum);
+        break;
+      case 2:
+        // general addition.
+        sum = sum.Add(sums[1 - index]);
+        expected_sum =
+          Pubkey::CombinePubkey(expected_sum, expected_sums[1 - index]);
+        break;
+      default:
+        // doubling.
+        sum = sum.Add(sum);
+        expected_sum = Pubkey::CombinePubkey(expected_sum, expected_sum);
+        break;
+    }
+    points.push_back(sum);
+    expected.push_back(expected_sum);
+  }
+
+  auto converted = JacobianPoint::ToPubkeys(points);
+  ASSERT_EQ(expected.size(), converted.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].GetHex(), converted[i].GetHex()) << "step " << i;
+  }
+}
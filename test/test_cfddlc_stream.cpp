@@ -0,0 +1,221 @@
+// Copyright 2020 CryptoGarage
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cfdcore/cfdcore_amount.h"
+#include "cfdcore/cfdcore_exception.h"
+#include "cfdcore/cfdcore_util.h"
+#include "cfddlc/cfddlc_stream.h"
+#include "gtest/gtest.h"
+
+using cfd::Amount;
+using cfd::Script;
+using cfd::Txid;
+using cfd::core::AdaptorPair;
+using cfd::core::ByteData256;
+using cfd::core::CfdException;
+using cfd::core::HashUtil;
+using cfd::core::Privkey;
+using cfd::core::Pubkey;
+using cfd::core::SchnorrPubkey;
+
+using cfd::dlc::CetSignatureVerifier;
+using cfd::dlc::CetTransactionParams;
+using cfd::dlc::DlcManager;
+using cfd::dlc::DlcOutcome;
+using cfd::dlc::StreamingCetSigner;
+
+const Privkey ORACLE_PRIVKEY(
+  "ded9a76a0a77399e1c2676324118a0386004633f16245ad30d172b15c1f9e2d3");
+const SchnorrPubkey ORACLE_PUBKEY = SchnorrPubkey::FromPrivkey(ORACLE_PRIVKEY);
+const std::vector<SchnorrPubkey> ORACLE_R_VALUES = {
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "be3cc8de25c50e25f69e2f88d151e3f63e99c3a44fed2bdd2e3ee70fe141c5c3")),
+  SchnorrPubkey::FromPrivkey(Privkey(
+    "9e1bc6dc95ce931903cc2df67640cf6cca94ddd96aab0b847780d644e46cfae3"))};
+const Privkey LOCAL_FUND_PRIVKEY(
+  "0000000000000000000000000000000000000000000000000000000000000001");
+const Pubkey LOCAL_FUND_PUBKEY = LOCAL_FUND_PRIVKEY.GeneratePubkey();
+const Pubkey REMOTE_FUND_PUBKEY =
+  Privkey("0000000000000000000000000000000000000000000000000000000000000002")
+    .GeneratePubkey();
+const Amount TOTAL_COLLATERAL = Amount::CreateBySatoshiAmount(200000000);
+
+static CetTransactionParams CreateParams() {
+  return {
+    Txid("83266d6b22a9babf6ee469b88fd0d3a0c690525f7c903aff22ec8ee44214604f"),
+    0,
+    Script("0014e8b9b1ab4c1cd3f76bcd8e5bdac28ef3e22e84b7"),
+    Script("0014c3a7d6e3b3e2a2e1f9e9b6d07c6a3cb0f3fd0b55"),
+    DlcManager::CreateFundTxLockingScript(
+      LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY),
+    TOTAL_COLLATERAL,
+    0,
+    0,
+    0};
+}
+
+static void CreateContract(
+  size_t nb_cets,
+  std::vector<DlcOutcome> *outcomes,
+  std::vector<std::vector<ByteData256>> *msgs) {
+  for (size_t i = 0; i < nb_cets; i++) {
+    auto local_payout =
+      Amount::CreateBySatoshiAmount(static_cast<int64_t>(i) * 1000000);
+    outcomes->push_back({local_payout, TOTAL_COLLATERAL - local_payout});
+    msgs->push_back(
+      {HashUtil::Sha256(std::to_string(i / 10)),
+       HashUtil::Sha256(std::to_string(i % 10))});
+  }
+}
+
+TEST(StreamingCetSigner, SignMatchesCreateCetAdaptorSignatures) {
+  auto params = CreateParams();
+  std::vector<DlcOutcome> outcomes;
+  std::vector<std::vector<ByteData256>> msgs;
+  CreateContract(23, &outcomes, &msgs);
+
+  auto cets = DlcManager::CreateCets(
+    params.fund_tx_id, params.fund_vout, params.local_final_script_pubkey,
+    params.remote_final_script_pubkey, outcomes);
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    params.funding_script_pubkey, params.fund_output_amount, msgs);
+
+  StreamingCetSigner signer(
+    params, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY, 5, 2);
+  size_t next = 0;
+  auto source = [&](
+                  size_t max_count, std::vector<DlcOutcome> *chunk_outcomes,
+                  std::vector<std::vector<ByteData256>> *chunk_msgs) {
+    for (; next < outcomes.size() && chunk_outcomes->size() < max_count;
+         next++) {
+      chunk_outcomes->push_back(outcomes[next]);
+      chunk_msgs->push_back(msgs[next]);
+    }
+  };
+  std::vector<AdaptorPair> adaptor_pairs;
+  auto sink = [&](size_t first_index, const std::vector<AdaptorPair> &pairs) {
+    EXPECT_EQ(adaptor_pairs.size(), first_index);
+    EXPECT_LE(pairs.size(), static_cast<size_t>(5));
+    adaptor_pairs.insert(adaptor_pairs.end(), pairs.begin(), pairs.end());
+  };
+
+  EXPECT_EQ(outcomes.size(), signer.Sign(source, sink));
+  ASSERT_EQ(expected.size(), adaptor_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      adaptor_pairs[i].signature.GetData().GetHex());
+    EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignature(
+      adaptor_pairs[i], cets[i], LOCAL_FUND_PUBKEY, ORACLE_PUBKEY,
+      ORACLE_R_VALUES, params.funding_script_pubkey,
+      params.fund_output_amount, msgs[i]));
+  }
+
+  // an exhausted source signs nothing.
+  EXPECT_EQ(static_cast<size_t>(0), signer.Sign(source, sink));
+}
+
+TEST(StreamingCetSigner, InvalidSource) {
+  auto params = CreateParams();
+  EXPECT_THROW(
+    StreamingCetSigner(
+      params, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY, 0),
+    CfdException);
+
+  std::vector<DlcOutcome> outcomes;
+  std::vector<std::vector<ByteData256>> msgs;
+  CreateContract(3, &outcomes, &msgs);
+  StreamingCetSigner signer(
+    params, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY, 2);
+  auto sink = [](size_t, const std::vector<AdaptorPair> &) {};
+
+  // more outcomes than requested.
+  EXPECT_THROW(
+    signer.Sign(
+      [&](
+        size_t, std::vector<DlcOutcome> *chunk_outcomes,
+        std::vector<std::vector<ByteData256>> *chunk_msgs) {
+        *chunk_outcomes = outcomes;
+        *chunk_msgs = msgs;
+      },
+      sink),
+    CfdException);
+  // missing messages.
+  EXPECT_THROW(
+    signer.Sign(
+      [&](
+        size_t, std::vector<DlcOutcome> *chunk_outcomes,
+        std::vector<std::vector<ByteData256>> *) {
+        chunk_outcomes->push_back(outcomes[0]);
+      },
+      sink),
+    CfdException);
+}
+
+TEST(CetSignatureVerifier, AddSignaturesByChunks) {
+  auto params = CreateParams();
+  std::vector<DlcOutcome> outcomes;
+  std::vector<std::vector<ByteData256>> msgs;
+  CreateContract(17, &outcomes, &msgs);
+  auto cets = DlcManager::CreateCets(
+    params.fund_tx_id, params.fund_vout, params.local_final_script_pubkey,
+    params.remote_final_script_pubkey, outcomes);
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    params.funding_script_pubkey, params.fund_output_amount, msgs);
+
+  CetSignatureVerifier verifier(
+    params, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY, ORACLE_R_VALUES, outcomes, msgs,
+    2);
+  size_t invalid_index = 0;
+  for (size_t begin = 0; begin < adaptor_pairs.size(); begin += 6) {
+    EXPECT_FALSE(verifier.Finalize(&invalid_index));
+    EXPECT_EQ(begin, invalid_index);
+    auto end = std::min(begin + 6, adaptor_pairs.size());
+    EXPECT_TRUE(verifier.AddSignatures(std::vector<AdaptorPair>(
+      adaptor_pairs.begin() + begin, adaptor_pairs.begin() + end)));
+    EXPECT_EQ(end, verifier.GetReceivedCount());
+  }
+  EXPECT_TRUE(verifier.Finalize(&invalid_index));
+  EXPECT_EQ(outcomes.size(), invalid_index);
+  EXPECT_THROW(verifier.AddSignatures({adaptor_pairs[0]}), CfdException);
+}
+
+TEST(CetSignatureVerifier, InvalidSignature) {
+  auto params = CreateParams();
+  std::vector<DlcOutcome> outcomes;
+  std::vector<std::vector<ByteData256>> msgs;
+  CreateContract(10, &outcomes, &msgs);
+  auto cets = DlcManager::CreateCets(
+    params.fund_tx_id, params.fund_vout, params.local_final_script_pubkey,
+    params.remote_final_script_pubkey, outcomes);
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_VALUES, LOCAL_FUND_PRIVKEY,
+    params.funding_script_pubkey, params.fund_output_amount, msgs);
+  std::swap(adaptor_pairs[6], adaptor_pairs[7]);
+
+  CetSignatureVerifier verifier(
+    params, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY, ORACLE_R_VALUES, outcomes, msgs);
+  EXPECT_TRUE(verifier.AddSignatures(std::vector<AdaptorPair>(
+    adaptor_pairs.begin(), adaptor_pairs.begin() + 4)));
+  EXPECT_FALSE(verifier.AddSignatures(std::vector<AdaptorPair>(
+    adaptor_pairs.begin() + 4, adaptor_pairs.begin() + 8)));
+  EXPECT_FALSE(verifier.AddSignatures(std::vector<AdaptorPair>(
+    adaptor_pairs.begin() + 8, adaptor_pairs.end())));
+
+  size_t invalid_index = 0;
+  EXPECT_FALSE(verifier.Finalize(&invalid_index));
+  EXPECT_EQ(static_cast<size_t>(6), invalid_index);
+
+  outcomes.pop_back();
+  EXPECT_THROW(
+    CetSignatureVerifier(
+      params, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY, ORACLE_R_VALUES, outcomes,
+      msgs),
+    CfdException);
+}
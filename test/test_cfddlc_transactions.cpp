@@ -1,5 +1,9 @@
 // Copyright 2019 CryptoGarage
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "cfd/cfd_transaction.h"
 #include "cfdcore/cfdcore_amount.h"
 #include "cfdcore/cfdcore_ecdsa_adaptor.h"
@@ -9,6 +13,9 @@
 #include "gtest/gtest.h"
 
 using cfd::Amount;
+using cfd::Script;
+using cfd::TransactionController;
+using cfd::core::AdaptorPair;
 using cfd::core::AdaptorUtil;
 using cfd::core::Address;
 using cfd::core::ByteData;
@@ -33,6 +40,8 @@ using cfd::core::TxOut;
 using cfd::core::WitnessVersion;
 
 using cfd::dlc::BatchPartyParams;
+using cfd::dlc::DlcContractContext;
+using cfd::dlc::DlcCryptoContext;
 using cfd::dlc::DlcManager;
 using cfd::dlc::DlcOutcome;
 using cfd::dlc::PartyParams;
@@ -520,10 +529,26 @@ TEST(DlcManager, CetTest) {
     remote_adaptor_pair, cet, REMOTE_FUND_PUBKEY, ORACLE_PUBKEY,
     {ORACLE_R_POINTS[0]}, fund_script, FUND_OUTPUT, {WIN_MESSAGES_HASH[0]}));
 
+  auto context_cet = cet;
   DlcManager::SignCet(
     &cet, local_adaptor_pair.signature, {ORACLE_SIGNATURES[0]},
     REMOTE_FUND_PRIVKEY, fund_script, FUND_TX_ID, 0, FUND_OUTPUT);
   EXPECT_EQ(cet.GetHex(), CET_HEX_SIGNED.GetHex());
+
+  DlcCryptoContext context(
+    ORACLE_PUBKEY, {ORACLE_R_POINTS[0]}, REMOTE_FUND_PRIVKEY,
+    LOCAL_FUND_PUBKEY);
+  DlcManager::SignCet(
+    &context_cet, local_adaptor_pair.signature, {ORACLE_SIGNATURES[0]},
+    context, fund_script, FUND_TX_ID, 0, FUND_OUTPUT);
+  EXPECT_EQ(context_cet.GetHex(), CET_HEX_SIGNED.GetHex());
+
+  // a key not part of the fund multisig script is rejected
+  EXPECT_THROW(
+    DlcManager::SignCet(
+      &context_cet, local_adaptor_pair.signature, {ORACLE_SIGNATURES[0]},
+      ORACLE_PRIVKEY, fund_script, FUND_TX_ID, 0, FUND_OUTPUT),
+    CfdException);
 }
 
 TEST(DlcManager, RefundTransactionTest) {
@@ -555,6 +580,116 @@ TEST(DlcManager, RefundTransactionTest) {
     FUND_OUTPUT, true, FUND_TX_ID, 0));
 }
 
+TEST(DlcContractContext, RefundTransactionTest) {
+  auto refund_tx = DlcManager::CreateRefundTransaction(
+    LOCAL_FINAL_ADDRESS.GetLockingScript(),
+    REMOTE_FINAL_ADDRESS.GetLockingScript(),
+    Amount::CreateBySatoshiAmount(100000000),
+    Amount::CreateBySatoshiAmount(100000000), 100, FUND_TX_ID, 0);
+  DlcContractContext local_contract(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY, FUND_TX_ID, 0, FUND_OUTPUT);
+  DlcContractContext remote_contract(
+    REMOTE_FUND_PUBKEY, LOCAL_FUND_PUBKEY, FUND_TX_ID, 0, FUND_OUTPUT);
+
+  auto local_signature = DlcManager::GetRawRefundTxSignature(
+    refund_tx, LOCAL_FUND_PRIVKEY, local_contract);
+  auto remote_signature = DlcManager::GetRawRefundTxSignature(
+    refund_tx, REMOTE_FUND_PRIVKEY, remote_contract);
+  auto remote_refund_tx = refund_tx;
+  DlcManager::AddSignaturesToRefundTx(
+    &refund_tx, local_contract, local_signature, remote_signature);
+  DlcManager::AddSignaturesToRefundTx(
+    &remote_refund_tx, remote_contract, remote_signature, local_signature);
+
+  EXPECT_EQ(
+    local_contract.GetFundLockingScript().GetHex(),
+    remote_contract.GetFundLockingScript().GetHex());
+  EXPECT_NE(
+    local_contract.IsLocalPubkeyFirst(), remote_contract.IsLocalPubkeyFirst());
+  EXPECT_EQ(REFUND_HEX.GetHex(), refund_tx.GetHex());
+  EXPECT_EQ(REFUND_HEX.GetHex(), remote_refund_tx.GetHex());
+  EXPECT_TRUE(DlcManager::VerifyRefundTxSignature(
+    refund_tx, local_signature, local_contract, false));
+  EXPECT_TRUE(DlcManager::VerifyRefundTxSignature(
+    refund_tx, remote_signature, local_contract, true));
+  EXPECT_FALSE(DlcManager::VerifyRefundTxSignature(
+    refund_tx, remote_signature, local_contract, false));
+}
+
+TEST(DlcContractContext, CetSignatures) {
+  std::vector<DlcOutcome> outcomes = {
+    {WIN_AMOUNT, LOSE_AMOUNT}, {LOSE_AMOUNT, WIN_AMOUNT}};
+  auto dlc_transactions = DlcManager::CreateDlcTransactions(
+    outcomes, LOCAL_PARAMS, REMOTE_PARAMS, REFUND_LOCKTIME, 1);
+  const auto &fund_tx = dlc_transactions.fund_transaction;
+  const auto &cets = dlc_transactions.cets;
+  auto fund_tx_id = fund_tx.GetTransaction().GetTxid();
+  auto fund_script = DlcManager::CreateFundTxLockingScript(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY);
+
+  DlcContractContext local_contract(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY, fund_tx);
+  DlcContractContext remote_contract(
+    REMOTE_FUND_PUBKEY, LOCAL_FUND_PUBKEY, fund_tx);
+  EXPECT_EQ(fund_tx_id.GetHex(), local_contract.GetFundTxId().GetHex());
+  EXPECT_EQ(static_cast<uint32_t>(0), local_contract.GetFundVout());
+  EXPECT_EQ(FUND_OUTPUT, local_contract.GetFundAmount());
+  EXPECT_EQ(
+    fund_script.GetHex(), local_contract.GetFundLockingScript().GetHex());
+  EXPECT_EQ(
+    fund_tx.GetTransaction().GetTxOut(0).GetLockingScript().GetHex(),
+    local_contract.GetFundScriptPubkey().GetHex());
+  EXPECT_THROW(
+    DlcContractContext(LOCAL_FUND_PUBKEY2, REMOTE_FUND_PUBKEY2, fund_tx),
+    CfdException);
+
+  std::vector<std::vector<ByteData256>> msgs = {
+    {WIN_MESSAGES_HASH[0]}, {WIN_MESSAGES_HASH[1]}};
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, {ORACLE_R_POINTS[0]}, LOCAL_FUND_PRIVKEY,
+    local_contract, msgs);
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, {ORACLE_R_POINTS[0]}, LOCAL_FUND_PRIVKEY, fund_script,
+    FUND_OUTPUT, msgs);
+  ASSERT_EQ(expected.size(), adaptor_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      adaptor_pairs[i].signature.GetData().GetHex());
+  }
+  EXPECT_EQ(
+    expected[0].signature.GetData().GetHex(),
+    DlcManager::CreateCetAdaptorSignature(
+      cets[0], ORACLE_PUBKEY, {ORACLE_R_POINTS[0]}, LOCAL_FUND_PRIVKEY,
+      local_contract, msgs[0])
+      .signature.GetData()
+      .GetHex());
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignature(
+    adaptor_pairs[0], cets[0], ORACLE_PUBKEY, {ORACLE_R_POINTS[0]},
+    remote_contract, true, msgs[0]));
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignature(
+    adaptor_pairs[0], cets[0], ORACLE_PUBKEY, {ORACLE_R_POINTS[0]},
+    local_contract, false, msgs[0]));
+  size_t invalid_index = 0;
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, adaptor_pairs, msgs, ORACLE_PUBKEY, {ORACLE_R_POINTS[0]},
+    remote_contract, true, 2, &invalid_index));
+  EXPECT_EQ(cets.size(), invalid_index);
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    cets, adaptor_pairs, msgs, ORACLE_PUBKEY, {ORACLE_R_POINTS[0]},
+    remote_contract, false));
+
+  auto expected_cet = cets[0];
+  DlcManager::SignCet(
+    &expected_cet, adaptor_pairs[0].signature, {ORACLE_SIGNATURES[0]},
+    REMOTE_FUND_PRIVKEY, fund_script, fund_tx_id, 0, FUND_OUTPUT);
+  auto cet = cets[0];
+  DlcManager::SignCet(
+    &cet, adaptor_pairs[0].signature, {ORACLE_SIGNATURES[0]},
+    REMOTE_FUND_PRIVKEY, remote_contract);
+  EXPECT_EQ(expected_cet.GetHex(), cet.GetHex());
+}
+
 TEST(DlcManager, CreateDlcTransactions) {
   // Arrange
   std::vector<DlcOutcome> outcomes = {
@@ -1150,3 +1285,401 @@ TEST(DlcManager, CetTestSerialId) {
     REMOTE_FUND_PRIVKEY, fund_script, FUND_TX_SERIAL_ID, 0, FUND_OUTPUT);
   EXPECT_EQ(cet.GetHex(), CET_SERIAL_ID_HEX_SIGNED.GetHex());
 }
+
+/**
+ * Contracts whose outcomes are a range of payouts, shared by the tests of
+ * the bulk adaptor signature functions.
+ */
+class DlcManagerTest : public ::testing::Test {
+ protected:
+  static std::vector<DlcOutcome> CreateRangeOutcomes(size_t nb_outcomes) {
+    std::vector<DlcOutcome> outcomes;
+    auto total = LOCAL_COLLATERAL_AMOUNT + REMOTE_COLLATERAL_AMOUNT;
+    for (size_t i = 0; i < nb_outcomes; i++) {
+      auto local_payout = Amount::CreateBySatoshiAmount(
+        WIN_AMOUNT.GetSatoshiValue() - static_cast<int64_t>(i) * 10000);
+      outcomes.push_back({local_payout, total - local_payout});
+    }
+    return outcomes;
+  }
+
+  static std::vector<std::vector<ByteData256>> CreateRangeMessages(
+    size_t nb_outcomes) {
+    std::vector<std::vector<ByteData256>> msgs;
+    for (size_t i = 0; i < nb_outcomes; i++) {
+      msgs.push_back(
+        {HashUtil::Sha256(std::to_string(i)),
+         HashUtil::Sha256(std::to_string(i % 2))});
+    }
+    return msgs;
+  }
+
+  // Creates the outcomes, messages and CETs of a contract of nb_outcomes
+  // outcomes.
+  void CreateContract(size_t nb_outcomes) {
+    outcomes_ = CreateRangeOutcomes(nb_outcomes);
+    msgs_ = CreateRangeMessages(nb_outcomes);
+    auto dlc_transactions = DlcManager::CreateDlcTransactions(
+      outcomes_, LOCAL_PARAMS, REMOTE_PARAMS, REFUND_LOCKTIME, 1);
+    cets_ = dlc_transactions.cets;
+    fund_amount_ =
+      dlc_transactions.fund_transaction.GetTransaction().GetTxOut(0).GetValue();
+  }
+
+  // Signs the CETs of the contract with the local fund key.
+  std::vector<AdaptorPair> SignCets(uint32_t nb_threads = 1) const {
+    return DlcManager::CreateCetAdaptorSignatures(
+      cets_, ORACLE_PUBKEY, ORACLE_R_POINTS, LOCAL_FUND_PRIVKEY, lock_script_,
+      fund_amount_, msgs_, nb_threads);
+  }
+
+  // Creates the signature hasher of CETs spending FUND_OUTPUT of FUND_TX_ID
+  // to the final addresses.
+  cfd::dlc::CetSignatureHasher CreateSignatureHasher(
+    const Amount &fund_output = FUND_OUTPUT) const {
+    cfd::dlc::CetTemplate cet_template(
+      FUND_TX_ID, 0, LOCAL_FINAL_ADDRESS.GetLockingScript(),
+      REMOTE_FINAL_ADDRESS.GetLockingScript());
+    return cfd::dlc::CetSignatureHasher(
+      cet_template, lock_script_, fund_output);
+  }
+
+  // Verifies signatures of the local party over the CETs of the contract.
+  bool VerifyCets(
+    const std::vector<AdaptorPair> &adaptor_pairs,
+    uint32_t nb_threads = 1,
+    size_t *invalid_index = nullptr) const {
+    return DlcManager::VerifyCetAdaptorSignatures(
+      cets_, adaptor_pairs, msgs_, LOCAL_FUND_PUBKEY, ORACLE_PUBKEY,
+      ORACLE_R_POINTS, lock_script_, fund_amount_, nb_threads,
+      invalid_index);
+  }
+
+  const Script lock_script_ = DlcManager::CreateFundTxLockingScript(
+    LOCAL_FUND_PUBKEY, REMOTE_FUND_PUBKEY);
+  std::vector<DlcOutcome> outcomes_;
+  std::vector<std::vector<ByteData256>> msgs_;
+  std::vector<TransactionController> cets_;
+  Amount fund_amount_;
+};
+
+using CetSignatureHasherTest = DlcManagerTest;
+
+TEST_F(DlcManagerTest, AdaptorSigParallelMatchesSerial) {
+  CreateContract(13);
+  auto serial_pairs = SignCets();
+
+  for (uint32_t nb_threads : {0, 1, 2, 3, 16}) {
+    auto parallel_pairs = SignCets(nb_threads);
+    ASSERT_EQ(serial_pairs.size(), parallel_pairs.size());
+    for (size_t i = 0; i < serial_pairs.size(); i++) {
+      EXPECT_EQ(
+        serial_pairs[i].signature.GetData().GetHex(),
+        parallel_pairs[i].signature.GetData().GetHex());
+      EXPECT_EQ(
+        serial_pairs[i].proof.GetData().GetHex(),
+        parallel_pairs[i].proof.GetData().GetHex());
+    }
+  }
+}
+
+TEST_F(DlcManagerTest, AdaptorSigParallelMoreMessagesThanNoncesFails) {
+  CreateContract(4);
+  msgs_[3].push_back(HashUtil::Sha256("extra"));
+
+  EXPECT_THROW(SignCets(2), CfdException);
+}
+
+TEST_F(DlcManagerTest, AdaptorSigParallelVerify) {
+  CreateContract(11);
+  auto adaptor_pairs = SignCets(4);
+
+  for (uint32_t nb_threads : {0, 1, 4}) {
+    EXPECT_TRUE(VerifyCets(adaptor_pairs, nb_threads));
+  }
+
+  // swapping two signatures must be detected wherever they are.
+  auto invalid_pairs = adaptor_pairs;
+  std::swap(invalid_pairs[9], invalid_pairs[10]);
+  for (uint32_t nb_threads : {0, 1, 4}) {
+    EXPECT_FALSE(VerifyCets(invalid_pairs, nb_threads));
+  }
+
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    cets_, adaptor_pairs, msgs_, REMOTE_FUND_PUBKEY, ORACLE_PUBKEY,
+    ORACLE_R_POINTS, lock_script_, fund_amount_, 3));
+}
+
+TEST_F(DlcManagerTest, AdaptorSigVerifyReportsFirstInvalidIndex) {
+  CreateContract(12);
+  auto adaptor_pairs = SignCets();
+
+  size_t invalid_index = 0;
+  EXPECT_TRUE(VerifyCets(adaptor_pairs, 3, &invalid_index));
+  EXPECT_EQ(cets_.size(), invalid_index);
+
+  auto invalid_pairs = adaptor_pairs;
+  std::swap(invalid_pairs[5], invalid_pairs[8]);
+  for (uint32_t nb_threads : {1, 2, 5}) {
+    EXPECT_FALSE(VerifyCets(invalid_pairs, nb_threads, &invalid_index));
+    EXPECT_EQ(static_cast<size_t>(5), invalid_index);
+  }
+}
+
+TEST_F(DlcManagerTest, AdaptorSigVerifyByBlocksReportsFirstInvalidIndex) {
+  CreateContract(300);
+  auto invalid_pairs = SignCets(4);
+
+  // the invalid signatures are in different blocks of indexes.
+  std::swap(invalid_pairs[200], invalid_pairs[290]);
+  size_t invalid_index = 0;
+  for (uint32_t nb_threads : {1, 2, 4}) {
+    EXPECT_FALSE(VerifyCets(invalid_pairs, nb_threads, &invalid_index));
+    EXPECT_EQ(static_cast<size_t>(200), invalid_index);
+  }
+}
+
+TEST(DlcManager, ComputeAdaptorPointMatchesSigPointSum) {
+  std::vector<SchnorrPubkey> r_values;
+  std::vector<ByteData256> msgs;
+  for (size_t i = 0; i < 10; i++) {
+    auto nonce = ORACLE_K_VALUES[i % 2].CreateTweakAdd(
+      HashUtil::Sha256(std::to_string(i)));
+    r_values.push_back(SchnorrPubkey::FromPrivkey(nonce));
+    msgs.push_back(HashUtil::Sha256(std::to_string(i % 2)));
+
+    auto expected = SchnorrUtil::ComputeSigPointBatch(
+      msgs, r_values, ORACLE_PUBKEY);
+    auto adaptor_point =
+      DlcManager::ComputeAdaptorPoint(msgs, r_values, ORACLE_PUBKEY);
+    EXPECT_EQ(expected.GetHex(), adaptor_point.GetHex());
+  }
+}
+
+TEST_F(DlcManagerTest, ComputeAdaptorPointsMatchesComputeAdaptorPoint) {
+  std::vector<SchnorrPubkey> r_values;
+  for (size_t i = 0; i < 6; i++) {
+    auto nonce = ORACLE_K_VALUES[i % 2].CreateTweakAdd(
+      HashUtil::Sha256(std::to_string(i)));
+    r_values.push_back(SchnorrPubkey::FromPrivkey(nonce));
+  }
+  std::vector<ByteData256> digits = {
+    HashUtil::Sha256("0"), HashUtil::Sha256("1")};
+  cfd::dlc::OracleEventPointTable table(ORACLE_PUBKEY, r_values, digits);
+
+  // digit prefixes of different lengths, in no particular order.
+  std::vector<std::vector<ByteData256>> prefix_msgs;
+  for (size_t i = 0; i < 40; i++) {
+    size_t nb_digits = 1 + (i * 7) % r_values.size();
+    std::vector<ByteData256> cet_msgs;
+    for (size_t j = 0; j < nb_digits; j++) {
+      cet_msgs.push_back(digits[((i * 13) >> j) & 1]);
+    }
+    prefix_msgs.push_back(cet_msgs);
+  }
+
+  for (const auto &msgs : {prefix_msgs, CreateRangeMessages(9)}) {
+    auto adaptor_points =
+      DlcManager::ComputeAdaptorPoints(msgs, r_values, ORACLE_PUBKEY);
+    ASSERT_EQ(msgs.size(), adaptor_points.size());
+    for (size_t i = 0; i < msgs.size(); i++) {
+      std::vector<SchnorrPubkey> cet_r_values(
+        r_values.begin(), r_values.begin() + msgs[i].size());
+      auto expected = DlcManager::ComputeAdaptorPoint(
+        msgs[i], cet_r_values, ORACLE_PUBKEY);
+      EXPECT_EQ(expected.GetHex(), adaptor_points[i].GetHex());
+    }
+  }
+
+  auto table_points = DlcManager::ComputeAdaptorPoints(prefix_msgs, table);
+  ASSERT_EQ(prefix_msgs.size(), table_points.size());
+  for (size_t i = 0; i < prefix_msgs.size(); i++) {
+    EXPECT_EQ(
+      table.ComputeAdaptorPoint(prefix_msgs[i]).GetHex(),
+      table_points[i].GetHex());
+  }
+  EXPECT_THROW(
+    DlcManager::ComputeAdaptorPoints(
+      std::vector<std::vector<ByteData256>>(1), r_values, ORACLE_PUBKEY),
+    CfdException);
+}
+
+TEST(DlcManager, CreateDlcTransactionsWithCetHandler) {
+  std::vector<DlcOutcome> outcomes;
+  for (int64_t i = 0; i < 10; i++) {
+    auto local_payout = Amount::CreateBySatoshiAmount(i * 20000000);
+    outcomes.push_back({local_payout, WIN_AMOUNT + LOSE_AMOUNT - local_payout});
+  }
+  auto dlc_transactions = DlcManager::CreateDlcTransactions(
+    outcomes, LOCAL_PARAMS, REMOTE_PARAMS, REFUND_LOCKTIME, 1);
+
+  std::vector<size_t> indexes;
+  std::vector<std::string> cet_hexes;
+  auto streamed_transactions = DlcManager::CreateDlcTransactions(
+    outcomes, LOCAL_PARAMS, REMOTE_PARAMS, REFUND_LOCKTIME, 1,
+    [&indexes, &cet_hexes](
+      size_t index, const cfd::TransactionController &cet) {
+      indexes.push_back(index);
+      cet_hexes.push_back(cet.GetHex());
+    });
+
+  EXPECT_TRUE(streamed_transactions.cets.empty());
+  EXPECT_EQ(
+    dlc_transactions.fund_transaction.GetHex(),
+    streamed_transactions.fund_transaction.GetHex());
+  EXPECT_EQ(
+    dlc_transactions.refund_transaction.GetHex(),
+    streamed_transactions.refund_transaction.GetHex());
+  ASSERT_EQ(outcomes.size(), dlc_transactions.cets.size());
+  ASSERT_EQ(outcomes.size(), cet_hexes.size());
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    EXPECT_EQ(i, indexes[i]);
+    EXPECT_EQ(dlc_transactions.cets[i].GetHex(), cet_hexes[i]);
+  }
+}
+
+TEST(CetTemplate, SerializeCetMatchesCreateCet) {
+  auto local_script = LOCAL_FINAL_ADDRESS.GetLockingScript();
+  auto remote_script = REMOTE_FINAL_ADDRESS.GetLockingScript();
+  auto total = WIN_AMOUNT + LOSE_AMOUNT;
+  // dust outputs on either side, and payouts on the dust limit.
+  std::vector<int64_t> local_payouts = {
+    0, 999, 1000, 123456789, 199999000, 199999001, 200000000};
+
+  for (uint64_t local_serial_id : {0, 2, 5}) {
+    cfd::dlc::CetTemplate cet_template(
+      FUND_TX_ID, 1, local_script, remote_script, 100, local_serial_id, 3);
+    std::vector<uint8_t> cet_bytes;
+    for (auto local_payout : local_payouts) {
+      auto local_amount = Amount::CreateBySatoshiAmount(local_payout);
+      DlcOutcome outcome = {local_amount, total - local_amount};
+      auto expected = DlcManager::CreateCet(
+        TxOut(outcome.local_payout, local_script),
+        TxOut(outcome.remote_payout, remote_script), FUND_TX_ID, 1, 100,
+        local_serial_id, 3);
+
+      cet_template.SerializeCet(outcome, &cet_bytes);
+      EXPECT_EQ(expected.GetHex(), ByteData(cet_bytes).GetHex());
+      EXPECT_EQ(
+        expected.GetHex(), cet_template.SerializeCet(outcome).GetHex());
+      EXPECT_EQ(expected.GetHex(), cet_template.CreateCet(outcome).GetHex());
+    }
+  }
+}
+
+TEST_F(CetSignatureHasherTest, GetSignatureHashMatchesTransaction) {
+  auto local_script = LOCAL_FINAL_ADDRESS.GetLockingScript();
+  auto remote_script = REMOTE_FINAL_ADDRESS.GetLockingScript();
+  auto total = WIN_AMOUNT + LOSE_AMOUNT;
+  std::vector<int64_t> local_payouts = {0, 999, 1000, 123456789, 200000000};
+
+  for (uint32_t lock_time : {0, 1000}) {
+    cfd::dlc::CetTemplate cet_template(
+      FUND_TX_ID, 2, local_script, remote_script, lock_time, 7, 3);
+    cfd::dlc::CetSignatureHasher sig_hasher(
+      cet_template, lock_script_, FUND_OUTPUT);
+    for (auto local_payout : local_payouts) {
+      auto local_amount = Amount::CreateBySatoshiAmount(local_payout);
+      DlcOutcome outcome = {local_amount, total - local_amount};
+      auto cet = cet_template.CreateCet(outcome);
+      auto expected = cet.GetTransaction().GetSignatureHash(
+        0, lock_script_.GetData(), SigHashType(), FUND_OUTPUT,
+        WitnessVersion::kVersion0);
+      EXPECT_EQ(
+        expected.GetHex(), sig_hasher.GetSignatureHash(outcome).GetHex());
+    }
+  }
+}
+
+TEST_F(CetSignatureHasherTest, AdaptorSignaturesFromOutcomes) {
+  auto outcomes = CreateRangeOutcomes(8);
+  auto msgs = CreateRangeMessages(outcomes.size());
+  auto cets = DlcManager::CreateCets(
+    FUND_TX_ID, 0, LOCAL_FINAL_ADDRESS.GetLockingScript(),
+    REMOTE_FINAL_ADDRESS.GetLockingScript(), outcomes);
+  auto expected = DlcManager::CreateCetAdaptorSignatures(
+    cets, ORACLE_PUBKEY, ORACLE_R_POINTS, LOCAL_FUND_PRIVKEY, lock_script_,
+    FUND_OUTPUT, msgs);
+
+  auto sig_hasher = CreateSignatureHasher();
+  auto adaptor_pairs = DlcManager::CreateCetAdaptorSignatures(
+    outcomes, sig_hasher, ORACLE_PUBKEY, ORACLE_R_POINTS, LOCAL_FUND_PRIVKEY,
+    msgs, 2);
+  ASSERT_EQ(expected.size(), adaptor_pairs.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(
+      expected[i].signature.GetData().GetHex(),
+      adaptor_pairs[i].signature.GetData().GetHex());
+  }
+
+  size_t invalid_index = 0;
+  EXPECT_TRUE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, msgs, LOCAL_FUND_PUBKEY,
+    ORACLE_PUBKEY, ORACLE_R_POINTS, 2, &invalid_index));
+  EXPECT_EQ(outcomes.size(), invalid_index);
+  std::swap(adaptor_pairs[3], adaptor_pairs[5]);
+  EXPECT_FALSE(DlcManager::VerifyCetAdaptorSignatures(
+    outcomes, sig_hasher, adaptor_pairs, msgs, LOCAL_FUND_PUBKEY,
+    ORACLE_PUBKEY, ORACLE_R_POINTS, 1, &invalid_index));
+  EXPECT_EQ(static_cast<size_t>(3), invalid_index);
+}
+
+TEST_F(CetSignatureHasherTest, GetSignatureHashesMatchesGetSignatureHash) {
+  auto sig_hasher = CreateSignatureHasher();
+  // includes dust outputs on both sides.
+  auto outcomes = CreateRangeOutcomes(21);
+  outcomes.push_back({Amount::CreateBySatoshiAmount(0), WIN_AMOUNT});
+  outcomes.push_back({WIN_AMOUNT, Amount::CreateBySatoshiAmount(500)});
+
+  auto sig_hashes = sig_hasher.GetSignatureHashes(outcomes);
+  ASSERT_EQ(outcomes.size(), sig_hashes.size());
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    EXPECT_EQ(
+      sig_hasher.GetSignatureHash(outcomes[i]).GetHex(),
+      sig_hashes[i].GetHex());
+  }
+}
+
+TEST_F(CetSignatureHasherTest, GetSignatureHashesReusesBuffers) {
+  auto sig_hasher = CreateSignatureHasher();
+  auto other_hasher =
+    CreateSignatureHasher(FUND_OUTPUT + Amount::CreateBySatoshiAmount(1));
+  auto outcomes = CreateRangeOutcomes(20);
+  outcomes.push_back({Amount::CreateBySatoshiAmount(0), WIN_AMOUNT});
+
+  // batches of decreasing then increasing sizes, switching hashers.
+  cfd::dlc::CetSignatureHasher::Buffers buffers;
+  const cfd::dlc::CetSignatureHasher *hashers[] = {
+    &sig_hasher, &sig_hasher, &other_hasher, &sig_hasher};
+  const size_t firsts[] = {0, 12, 15, 2};
+  const size_t sizes[] = {12, 3, 6, 19};
+  for (size_t batch = 0; batch < 4; batch++) {
+    const auto *hasher = hashers[batch];
+    auto sig_hashes = hasher->GetSignatureHashes(
+      outcomes.data() + firsts[batch], sizes[batch], &buffers);
+    ASSERT_EQ(sizes[batch], sig_hashes.size());
+    for (size_t i = 0; i < sizes[batch]; i++) {
+      EXPECT_EQ(
+        hasher->GetSignatureHash(outcomes[firsts[batch] + i]).GetHex(),
+        sig_hashes[i].GetHex());
+    }
+  }
+}
+
+TEST_F(CetSignatureHasherTest, GetSignatureHashesAcrossContracts) {
+  auto outcomes = CreateRangeOutcomes(8);
+
+  // a hasher per contract, likely created at the same address each time.
+  cfd::dlc::CetSignatureHasher::Buffers buffers;
+  for (int64_t contract = 0; contract < 3; contract++) {
+    auto sig_hasher = CreateSignatureHasher(
+      FUND_OUTPUT + Amount::CreateBySatoshiAmount(contract));
+    auto sig_hashes =
+      sig_hasher.GetSignatureHashes(outcomes.data(), outcomes.size(), &buffers);
+    for (size_t i = 0; i < outcomes.size(); i++) {
+      EXPECT_EQ(
+        sig_hasher.GetSignatureHash(outcomes[i]).GetHex(),
+        sig_hashes[i].GetHex());
+    }
+  }
+}